@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <bitset>
 #include <cctype>
 #include <deque>
 #include <limits.h>
@@ -9,9 +11,12 @@
 #include <set>
 #include <sstream>
 #include <stack>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -34,12 +39,16 @@ typedef std::set<BigInt> BigIntSet;
 typedef std::deque<BigInt> BigIntDeque;
 
 typedef unsigned long long BigUInt;
+typedef std::vector<BigUInt> BigUIntList;
 
 const BigInt MAX_BIG_INT = LLONG_MAX;
 const BigInt MIN_BIG_INT = LLONG_MIN;
 const BigInt MAX_BIG_UINT = ULLONG_MAX;
 
 typedef std::vector<bool> BoolList;
+typedef std::vector<BigUInt> BitWordList;
+
+inline BigInt CountBits(BigUInt bits) { return (BigInt)std::bitset<64>(bits).count(); }
 
 
 ////////////////////////////
@@ -185,6 +194,61 @@ private:
 
 extern FactorizationCache g_factorizationCache;
 
+inline BigUInt CalcGreatestCommonDivisor(BigUInt a, BigUInt b)
+{
+    while (b != 0)
+    {
+        const BigUInt rem = a % b;
+        a = b;
+        b = rem;
+    }
+    return a;
+}
+
+// returns false if the least common multiple of a and b (both nonzero) doesn't fit in 64 bits
+inline bool CalcLeastCommonMultiple(BigUInt a, BigUInt b, BigUInt& lcm)
+{
+    const BigUInt reducedA = a / CalcGreatestCommonDivisor(a, b);
+    if (reducedA > ULLONG_MAX / b)
+        return false;
+    lcm = reducedA * b;
+    return true;
+}
+
+
+////////////////////////////
+// Modular Arithmetic
+
+// (a + b) % modulus, without overflowing for any 64-bit modulus
+inline BigUInt AddMod(BigUInt a, BigUInt b, BigUInt modulus)
+{
+    a %= modulus;
+    b %= modulus;
+    return (a >= modulus - b) ? (a - (modulus - b)) : (a + b);
+}
+
+// (a * b) % modulus, without overflowing for any 64-bit modulus
+inline BigUInt MulMod(BigUInt a, BigUInt b, BigUInt modulus)
+{
+    if ((a <= 0xFFFFFFFFULL) && (b <= 0xFFFFFFFFULL))
+        return (a * b) % modulus;
+
+#if defined(__SIZEOF_INT128__)
+    return (BigUInt)(((unsigned __int128)a * b) % modulus);
+#else
+    BigUInt result = 0;
+    a %= modulus;
+    while (b != 0)
+    {
+        if (b & 1)
+            result = AddMod(result, a, modulus);
+        a = AddMod(a, a, modulus);
+        b >>= 1;
+    }
+    return result;
+#endif
+}
+
 
 ////////////////////////////
 // Strings
@@ -250,6 +314,88 @@ void IntersectSet(std::set<T>& lhs, const std::set<T>& rhs)
 }
 
 
+////////////////////////////
+// Hash Index Table
+
+// Open-addressing hash table from 64-bit keys to 32-bit indices, with linear probing and growth at half load.  Several
+// entries may share a key (e.g. when keys are hashes of something larger), so lookups can confirm each candidate.
+class HashIndexTable
+{
+public:
+    static const uint32_t NO_INDEX = UINT32_MAX;
+
+    HashIndexTable() { m_slotList.resize(INITIAL_CAPACITY); }
+
+    BigInt GetSize() const { return m_size; }
+
+    // the first index stored under the key for which isMatch(index) is true, or NO_INDEX
+    template<typename MATCH>
+    uint32_t Find(BigUInt key, const MATCH& isMatch) const
+    {
+        const BigInt slotMask = m_slotList.size() - 1;
+        for (BigInt slot = GetHomeSlot(key); m_slotList[slot].index != NO_INDEX; slot = (slot + 1) & slotMask)
+        {
+            if ((m_slotList[slot].key == key) && isMatch(m_slotList[slot].index))
+                return m_slotList[slot].index;
+        }
+        return NO_INDEX;
+    }
+
+    uint32_t Find(BigUInt key) const
+    {
+        return Find(key, [](uint32_t) { return true; });
+    }
+
+    // always adds a new entry, even if the key is already present
+    void Insert(BigUInt key, uint32_t index)
+    {
+        assert(index != NO_INDEX);
+        if ((m_size + 1) * 2 > (BigInt)m_slotList.size())
+            Grow();
+        Place(key, index);
+        ++m_size;
+    }
+
+private:
+    static const BigInt INITIAL_CAPACITY = 1024;
+
+    struct Slot
+    {
+        BigUInt key = 0;
+        uint32_t index = NO_INDEX;
+    };
+
+    std::vector<Slot> m_slotList;
+    BigInt m_size = 0;
+
+    BigInt GetHomeSlot(BigUInt key) const
+    {
+        return (BigInt)((key * 0x9E3779B97F4A7C15ULL) >> 20) & (BigInt)(m_slotList.size() - 1);
+    }
+
+    void Place(BigUInt key, uint32_t index)
+    {
+        const BigInt slotMask = m_slotList.size() - 1;
+        BigInt slot = GetHomeSlot(key);
+        while (m_slotList[slot].index != NO_INDEX)
+            slot = (slot + 1) & slotMask;
+        m_slotList[slot].key = key;
+        m_slotList[slot].index = index;
+    }
+
+    void Grow()
+    {
+        std::vector<Slot> oldSlotList(m_slotList.size() * 2);
+        oldSlotList.swap(m_slotList);
+        for (const Slot& oldSlot: oldSlotList)
+        {
+            if (oldSlot.index != NO_INDEX)
+                Place(oldSlot.key, oldSlot.index);
+        }
+    }
+};
+
+
 ////////////////////////////
 // Circular Buffer
 
@@ -442,6 +588,38 @@ typedef PermutationIterator<BigInt> BigIntListPermutationIterator;
 void TestPermutationIterator(BigInt numEntries);
 
 
+////////////////////////////
+// Parallel For
+
+// Calls func(taskIndex) for every task index in [0, numTasks), spread across the hardware threads.  Tasks are handed
+// out from a shared counter, so which thread runs which task varies; callers should write each task's results to its
+// own slot and combine them afterwards.
+template<typename FUNC>
+void ParallelFor(BigInt numTasks, const FUNC& func)
+{
+    const BigInt numThreads = std::min(numTasks, (BigInt)std::max(1U, std::thread::hardware_concurrency()));
+
+    std::atomic<BigInt> nextTaskIndex(0);
+    auto runTasks = [&]()
+    {
+        for (;;)
+        {
+            const BigInt taskIndex = nextTaskIndex++;
+            if (taskIndex >= numTasks)
+                break;
+            func(taskIndex);
+        }
+    };
+
+    std::vector<std::thread> threadList;
+    for (BigInt i = 1; i < numThreads; ++i)
+        threadList.emplace_back(runTasks);
+    runTasks();
+    for (std::thread& thread: threadList)
+        thread.join();
+}
+
+
 ////////////////////////////
 // Problem Harness
 
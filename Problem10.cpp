@@ -16,156 +16,229 @@ public:
     }
 
 private:
+    // The program is compiled once into a packed array of instructions, each knowing how many cycles it takes and how
+    // much it changes register X by when it finishes, so the CPU can leap over whole instructions at a time.
     class CPU
     {
     public:
+        enum Opcode : uint8_t
+        {
+            NOOP,
+            ADDX,
+        };
+
+        struct Instruction
+        {
+            int32_t arg = 0;   // always 0 for a noop, so finishing any instruction is just adding it to X
+            Opcode opcode = NOOP;
+            uint8_t numCycles = 1;
+        };
+
         CPU(const char* filename, bool verbose) : m_verbose(verbose)
         {
-            ReadFileLines(filename, m_instructions);
-            FetchNextInstruction(true /*init*/);
+            StringList lines;
+            ReadFileLines(filename, lines);
+            Compile(lines);
+            Reset();
         }
 
+        const std::vector<Instruction>& GetProgram() const { return m_program; }
+        BigInt GetNumCycles() const { return m_numCycles; }
+
         BigInt GetCycleNumber() const { return m_cycleNumber; }
         BigInt GetRegisterX() const { return m_registerX; }
         BigInt GetSignalStrength() const { return (m_cycleNumber * m_registerX); }
 
-        bool StepOneCycle()
+        void Reset()
         {
-            if (m_verbose)
-                printf("Stepping cycle number %lld\n", m_cycleNumber);
+            m_nextInstructionIndex = 0;
+            m_nextInstructionStartCycle = 1;
+            m_cycleNumber = 1;
+            m_registerX = 1;
+        }
 
-            bool shouldContinue = true;
-            if (!HaveCurrInstruction())
+        // Advances to the given cycle, after which register X holds its value DURING that cycle.  Every instruction
+        // that finishes before then is applied whole.  Returns false, without moving, if the program ends first.
+        bool ExecuteUntil(BigInt cycleNumber)
+        {
+            assert(cycleNumber >= m_cycleNumber);
+            if (cycleNumber > m_numCycles)
             {
                 if (m_verbose)
-                    printf("  No more instructions remaining!\n");
-                shouldContinue = false;
+                    printf("  Program ends at cycle %lld, before cycle %lld\n", m_numCycles, cycleNumber);
+                return false;
             }
-            else if (CurrInstructionReadyToFinish())
+
+            for (;;)
             {
-                if (m_verbose)
-                    printf("  Curr instruction ready to finish\n");
+                const Instruction& instruction = m_program[m_nextInstructionIndex];
+                const BigInt finishCycle = m_nextInstructionStartCycle + instruction.numCycles - 1;
+                if (finishCycle >= cycleNumber)
+                    break;
 
-                FinishCurrInstruction();
-                if (!FetchNextInstruction())
-                    shouldContinue = false;
-            }
+                m_registerX += instruction.arg;
+                m_nextInstructionStartCycle = finishCycle + 1;
+                ++m_nextInstructionIndex;
 
-            if (shouldContinue)
-            {
-                ++m_cycleNumber;
                 if (m_verbose)
-                    printf("  Cycle number now %lld\n", m_cycleNumber);
+                    printf(
+                        "  Finished %s %d at cycle %lld, X now %lld\n",
+                        (instruction.opcode == NOOP) ? "noop" : "addx",
+                        instruction.arg,
+                        finishCycle,
+                        m_registerX);
             }
 
-            return shouldContinue;
+            m_cycleNumber = cycleNumber;
+            return true;
         }
 
     private:
-        enum class Instruction
-        {
-            None,
-            Noop,
-            Add,
-        };
+        bool m_verbose = false;
+
+        std::vector<Instruction> m_program;
+        BigInt m_numCycles = 0;
 
-        StringList m_instructions;
         BigInt m_nextInstructionIndex = 0;
-        bool m_verbose = false;
+        BigInt m_nextInstructionStartCycle = 1;
         BigInt m_cycleNumber = 1;
-
         BigInt m_registerX = 1;
 
-        Instruction m_currInstruction = Instruction::None;
-        BigInt m_currInstructionArg = 0;
-        BigInt m_currInstructionFinishCycle = -1;
-
-        bool HaveCurrInstruction() const { return (m_currInstruction != Instruction::None); }
-        bool CurrInstructionReadyToFinish() const { return (m_cycleNumber >= m_currInstructionFinishCycle); }
-        void FinishCurrInstruction()
+        void Compile(const StringList& lines)
         {
-            switch (m_currInstruction)
+            m_program.clear();
+            m_program.reserve(lines.size());
+            m_numCycles = 0;
+
+            for (const std::string& line: lines)
             {
-                case Instruction::Noop:
-                    if (m_verbose)
-                        printf("  Executing Noop\n");
-                    break;
-                case Instruction::Add:
-                    m_registerX += m_currInstructionArg;
-                    if (m_verbose)
-                        printf(
-                            "  Executing Add:  %lld(X) += %lld = %lld\n",
-                            m_registerX - m_currInstructionArg,
-                            m_currInstructionArg,
-                            m_registerX);
-                    break;
-                default:
-                    break;
+                const char* st = line.c_str();
+
+                Instruction instruction;
+                if (strncmp(st, "addx", 4) == 0)
+                {
+                    BigInt arg = 0;
+                    ParseNextBigInt(st, arg, true /*checkForNegation*/);
+                    instruction.arg = (int32_t)arg;
+                    instruction.opcode = ADDX;
+                    instruction.numCycles = 2;
+                }
+                else
+                {
+                    assert(strncmp(st, "noop", 4) == 0);
+                }
+
+                m_program.push_back(instruction);
+                m_numCycles += instruction.numCycles;
             }
-            m_currInstruction = Instruction::None;
         }
-        bool FetchNextInstruction(bool init = false)
+    };
+
+    // Register X over a whole compiled program, as the cycles at which X changes alongside the value it changes to.
+    // X during any cycle is then a binary search away, and lookups don't depend on each other, so they can be spread
+    // across threads.
+    class RegisterTimeline
+    {
+    public:
+        RegisterTimeline(const std::vector<CPU::Instruction>& program)
         {
-            if (m_nextInstructionIndex >= (BigInt)m_instructions.size())
-                return false;
+            BigInt cycleNumber = 1;
+            BigInt registerX = 1;
+            m_changeCycleList.push_back(cycleNumber);
+            m_valueList.push_back(registerX);
 
-            StringList tokens;
-            Tokenize(m_instructions[m_nextInstructionIndex], tokens, ' ');
-            if (tokens[0] == "noop")
+            for (const CPU::Instruction& instruction: program)
             {
-                m_currInstruction = Instruction::Noop;
-                m_currInstructionArg = 0;
-                m_currInstructionFinishCycle = m_cycleNumber;
-            }
-            else
-            {
-                m_currInstruction = Instruction::Add;
-                m_currInstructionArg = atoll(tokens[1].c_str());
-                m_currInstructionFinishCycle = m_cycleNumber + 1;
+                cycleNumber += instruction.numCycles;
+                if (instruction.arg == 0)
+                    continue;
+
+                registerX += instruction.arg;
+                m_changeCycleList.push_back(cycleNumber);
+                m_valueList.push_back(registerX);
             }
 
-            if (!init)
-                ++m_currInstructionFinishCycle;
+            m_numCycles = cycleNumber - 1;
+        }
 
-            ++m_nextInstructionIndex;
+        BigInt GetNumCycles() const { return m_numCycles; }
 
-            if (m_verbose)
-                printf(
-                    "  Next instruction = %s, arg = %lld, finish cycle = %lld\n",
-                    tokens[0].c_str(),
-                    m_currInstructionArg,
-                    m_currInstructionFinishCycle);
+        // X during the given cycle
+        BigInt GetRegisterX(BigInt cycleNumber) const
+        {
+            BigInt lastCycleNumber = 0;
+            return GetRegisterX(cycleNumber, lastCycleNumber);
+        }
 
-            return true;
+        // X during the given cycle, plus the last cycle that X keeps that value through
+        BigInt GetRegisterX(BigInt cycleNumber, BigInt& lastCycleNumber) const
+        {
+            assert((cycleNumber >= 1) && (cycleNumber <= m_numCycles));
+            const auto iter = std::upper_bound(m_changeCycleList.begin(), m_changeCycleList.end(), cycleNumber);
+            lastCycleNumber = (iter != m_changeCycleList.end()) ? (*iter - 1) : m_numCycles;
+            return m_valueList[(iter - m_changeCycleList.begin()) - 1];
         }
+
+    private:
+        BigIntList m_changeCycleList;
+        BigIntList m_valueList;
+        BigInt m_numCycles = 0;
     };
 
+    // Each row of the display is a bitmask, one bit per pixel, so a whole stretch of pixels drawn while the sprite
+    // stays put is lit with a single mask, and the text form only gets built when printing
     class CRT
     {
     public:
-        CRT()
+        CRT(BigInt rowLength = 40, BigInt numRows = 6)
+            : m_rowLength(rowLength), m_numRows(numRows), m_numWordsPerRow((rowLength + 63) / 64)
         {
-            m_display.resize(NUM_ROWS);
-            for (std::string& row: m_display)
-                row.resize(ROW_LENGTH, '.');
+            m_pixelWordList.resize(m_numRows * m_numWordsPerRow, 0);
         }
 
-        BigInt GetNumRows() const { return NUM_ROWS; }
-        BigInt GetRowLength() const { return ROW_LENGTH; }
+        BigInt GetNumRows() const { return m_numRows; }
+        BigInt GetRowLength() const { return m_rowLength; }
 
-        void PlotPixel(BigInt x, BigInt y) { m_display[y][x] = '#'; }
+        // lights whichever pixels from firstX to lastX of row y the sprite, centered on spriteX, covers.  Rows don't
+        // share any words, so different rows can be plotted from different threads.
+        void PlotSpriteSpan(BigInt y, BigInt firstX, BigInt lastX, BigInt spriteX)
+        {
+            const BigInt litFirstX = std::max(std::max(firstX, spriteX - 1), 0LL);
+            const BigInt litLastX = std::min(std::min(lastX, spriteX + 1), m_rowLength - 1);
+            if (litFirstX > litLastX)
+                return;
+
+            BigUInt* rowWords = &m_pixelWordList[y * m_numWordsPerRow];
+            for (BigInt word = litFirstX / 64; word <= litLastX / 64; ++word)
+            {
+                const BigInt wordFirstX = std::max(litFirstX, word * 64) - word * 64;
+                const BigInt wordLastX = std::min(litLastX, word * 64 + 63) - word * 64;
+                const BigUInt upToLastMask = (wordLastX == 63) ? ~0ULL : ((1ULL << (wordLastX + 1)) - 1);
+                rowWords[word] |= upToLastMask & ~((1ULL << wordFirstX) - 1);
+            }
+        }
 
         void Print(const char* indent) const
         {
-            for (const std::string& row: m_display)
-                printf("%s%s\n", indent, row.c_str());
+            std::string rowText;
+            for (BigInt y = 0; y < m_numRows; ++y)
+            {
+                const BigUInt* rowWords = &m_pixelWordList[y * m_numWordsPerRow];
+                rowText.assign(m_rowLength, '.');
+                for (BigInt x = 0; x < m_rowLength; ++x)
+                {
+                    if (rowWords[x / 64] & (1ULL << (x % 64)))
+                        rowText[x] = '#';
+                }
+                printf("%s%s\n", indent, rowText.c_str());
+            }
         }
-        void PrintRow(const char* indent, BigInt y) { printf("%s%s\n", indent, m_display[y].c_str()); }
 
     private:
-        static const BigInt NUM_ROWS = 6;
-        static const BigInt ROW_LENGTH = 40;
-        StringList m_display;
+        BigInt m_rowLength = 0;
+        BigInt m_numRows = 0;
+        BigInt m_numWordsPerRow = 0;
+        BitWordList m_pixelWordList;
     };
 
     void RunOnData(const char* filename, bool showCRT, bool verbose)
@@ -175,39 +248,49 @@ private:
         CPU cpu(filename, verbose);
         CRT crt;
 
+        // jump straight from one sampling cycle to the next
+
         BigInt sumSignalValues = 0;
-        do
+        for (BigInt cycleNum = 20; (cycleNum <= 220) && cpu.ExecuteUntil(cycleNum); cycleNum += 40)
         {
-            const BigInt cycleNum = cpu.GetCycleNumber();
-            if ((cycleNum >= 20) && (((cycleNum - 20) % 40) == 0) && (cycleNum <= 220))
-            {
-                const BigInt signalVal = cpu.GetSignalStrength();
-                sumSignalValues += signalVal;
+            const BigInt signalVal = cpu.GetSignalStrength();
+            sumSignalValues += signalVal;
 
-                if (verbose)
-                    printf(
-                        "At cycle num %lld, signal strength is %lld, running total is %lld\n",
-                        cycleNum,
-                        signalVal,
-                        sumSignalValues);
-            }
+            if (verbose)
+                printf("At cycle num %lld, signal strength is %lld, running total is %lld\n", cycleNum, signalVal, sumSignalValues);
+        }
 
-            if (showCRT)
-            {
-                const BigInt spriteX = cpu.GetRegisterX();
-                const BigInt cycleIndex = cycleNum - 1;
-                const BigInt pixelX = cycleIndex % crt.GetRowLength();
-                const BigInt pixelY = cycleIndex / crt.GetRowLength();
-                if ((pixelX >= 0) && (pixelX < crt.GetRowLength()) && (pixelY >= 0) && (pixelY < crt.GetNumRows()))
-                {
-                    if (std::abs(spriteX - pixelX) <= 1)
-                        crt.PlotPixel(pixelX, pixelY);
+        const RegisterTimeline timeline(cpu.GetProgram());
 
-                    if (verbose)
-                        crt.PrintRow("  ", pixelY);
-                }
-            }
-        } while (cpu.StepOneCycle());
+        BigInt timelineSumSignalValues = 0;
+        for (BigInt cycleNum = 20; (cycleNum <= 220) && (cycleNum <= timeline.GetNumCycles()); cycleNum += 40)
+            timelineSumSignalValues += cycleNum * timeline.GetRegisterX(cycleNum);
+        assert(timelineSumSignalValues == sumSignalValues);
+
+        // every pixel only needs X during its own cycle, so the rows can all be drawn at once, a span of unchanging X
+        // at a time
+
+        if (showCRT)
+        {
+            ParallelFor(
+                crt.GetNumRows(),
+                [&](BigInt pixelY)
+                {
+                    const BigInt rowFirstCycleNum = pixelY * crt.GetRowLength() + 1;
+                    const BigInt rowLastCycleNum = std::min(rowFirstCycleNum + crt.GetRowLength() - 1, timeline.GetNumCycles());
+
+                    BigInt cycleNum = rowFirstCycleNum;
+                    while (cycleNum <= rowLastCycleNum)
+                    {
+                        BigInt spanLastCycleNum = 0;
+                        const BigInt spriteX = timeline.GetRegisterX(cycleNum, spanLastCycleNum);
+                        spanLastCycleNum = std::min(spanLastCycleNum, rowLastCycleNum);
+
+                        crt.PlotSpriteSpan(pixelY, cycleNum - rowFirstCycleNum, spanLastCycleNum - rowFirstCycleNum, spriteX);
+                        cycleNum = spanLastCycleNum + 1;
+                    }
+                });
+        }
 
         printf("Sum of signal values = %lld\n\n", sumSignalValues);
 
@@ -15,412 +15,623 @@ public:
 
         RunOnData("Day11Example.txt", 10000, true, false);
         RunOnData("Day11Input.txt", 10000, true, false);
-    }
-
-private:
-    enum Primes
-    {
-        Two,
-        Three,
-        Five,
-        Seven,
-        Eleven,
-        Thirteen,
-        Seventeen,
-        Nineteen,
-        TwentyThree,
-        NUM_PRIMES
-    };
 
-    static const BigInt MAX_PRIME = 29;
+        RunOnDataFastForward("Day11Example.txt", 10000, false);
+        RunOnDataFastForward("Day11Input.txt", 10000, false);
+        RunOnDataFastForward("Day11Input.txt", 1000000000000, false);
 
-    static const BigInt s_primeNumbers[NUM_PRIMES];
-    static const BigInt s_primeNumberToIndex[MAX_PRIME];
+        RunOnDataParallelItems("Day11Example.txt", 10000, false);
+        RunOnDataParallelItems("Day11Input.txt", 10000, false);
+    }
 
-    class PrimeRelativeNumber
+private:
+    class Monkey
     {
     public:
-        void InitPrime(BigInt p) { m_prime = p; }
+        enum Operation
+        {
+            ADD_CONST,
+            SUB_CONST,
+            MUL_CONST,
+            DIV_CONST,
+            SQUARE,
+            SET_CONST,
+        };
+
+        void SetMonkeyIndex(BigInt monkeyIndex) { m_monkeyIndex = monkeyIndex; }
+
+        // Parses whichever of the monkey's description lines this is, straight out of the line's text, returning false
+        // if the line isn't recognized
+        bool ParseLine(const char* st)
+        {
+            if (SkipWord(st, "Starting"))
+            {
+                BigInt num = 0;
+                while (ParseNextBigInt(st, num))
+                    m_itemList.push_back(num);
+                return true;
+            }
 
-        void SetToValue(BigInt value) { m_mod = value % m_prime; }
+            if (SkipWord(st, "Operation:"))
+                return SkipWord(st, "new") && SkipWord(st, "=") && ParseOperation(st);
 
-        bool IsDivisible() const { return (m_mod == 0); }
+            if (SkipWord(st, "Test:"))
+                return ParseNextBigInt(st, m_testDivisor) && (m_testDivisor > 0);
 
-        void AddNumber(BigInt num)
-        {
-            m_mod += num;
-            m_mod %= m_prime;
-        }
-        void AddNumber(const PrimeRelativeNumber& rhs)
-        {
-            m_mod += rhs.m_mod;
-            m_mod %= m_prime;
+            if (SkipWord(st, "If"))
+            {
+                const bool isTrue = SkipWord(st, "true:");
+                if (!isTrue && !SkipWord(st, "false:"))
+                    return false;
+                return ParseNextBigInt(st, isTrue ? m_throwToMonkeyIfTrue : m_throwToMonkeyIfFalse);
+            }
+
+            return false;
         }
-        void MultiplyNumber(BigInt num)
+
+        BigInt GetMonkeyIndex() const { return m_monkeyIndex; }
+        BigInt GetTestDivisor() const { return m_testDivisor; }
+        BigInt GetThrowToMonkeyIfTrue() const { return m_throwToMonkeyIfTrue; }
+        BigInt GetThrowToMonkeyIfFalse() const { return m_throwToMonkeyIfFalse; }
+        Operation GetOperation() const { return m_operation; }
+        const BigUIntList& GetItems() const { return m_itemList; }
+
+        // Part two keeps worry levels as residues modulo the least common multiple of every monkey's test divisor,
+        // which leaves every divisibility test intact while keeping the numbers bounded
+        void SetModulusPartTwo(BigUInt modulus)
         {
-            m_mod *= num;
-            m_mod %= m_prime;
+            assert(m_operation != DIV_CONST);   // division doesn't survive being reduced
+            m_modulus = modulus;
+            m_operand %= modulus;
+            if (m_operation == SUB_CONST)
+            {
+                // subtracting is adding the negation, modulo the modulus
+                m_operation = ADD_CONST;
+                m_operand = (modulus - m_operand) % modulus;
+            }
+            for (BigUInt& item: m_itemList)
+                item %= modulus;
         }
-        void MultiplyNumber(const PrimeRelativeNumber& rhs)
+
+        // A whole turn at once:  the operation runs over the monkey's entire item buffer in one tight loop, then a
+        // single pass splits the items between the two monkeys they get thrown to
+        void TakeTurn(std::vector<Monkey>& monkeyList, bool verbose)
         {
-            m_mod *= rhs.m_mod;
-            m_mod %= m_prime;
-        }
+            if (m_itemList.empty())
+            {
+                if (verbose)
+                    printf("  Monkey has no items to inspect\n");
+                return;
+            }
 
-    private:
-        BigInt m_prime = 0;
-        BigInt m_mod = 0;
-    };
+            ApplyOperationToAll();
 
-    class ItemNumber
-    {
-    public:
-        ItemNumber(BigInt num = 0)
-        {
-            for (BigInt index = Two; index < NUM_PRIMES; ++index)
+            BigUIntList& trueItemList = monkeyList[m_throwToMonkeyIfTrue].m_itemList;
+            BigUIntList& falseItemList = monkeyList[m_throwToMonkeyIfFalse].m_itemList;
+            assert(&trueItemList != &m_itemList);
+            assert(&falseItemList != &m_itemList);
+
+            for (BigUInt item: m_itemList)
             {
-                PrimeRelativeNumber& prn = m_primeRels[index];
-                prn.InitPrime(s_primeNumbers[index]);
-                prn.SetToValue(num);
+                const bool testResult = ((item % m_testDivisor) == 0);
+                if (verbose)
+                    printf(
+                        "  Item becomes %llu, throwing to monkey %lld\n",
+                        item,
+                        testResult ? m_throwToMonkeyIfTrue : m_throwToMonkeyIfFalse);
+
+                (testResult ? trueItemList : falseItemList).push_back(item);
             }
+
+            m_numTimesInspected += m_itemList.size();
+            m_itemList.clear();
         }
 
-        ItemNumber& operator=(BigInt num)
+        // inspects a single item (part two) without it belonging to the monkey, returning the monkey it gets thrown to
+        BigInt InspectItemPartTwo(BigUInt& item) const
         {
-            for (BigInt index = Two; index < NUM_PRIMES; ++index)
+            switch (m_operation)
             {
-                PrimeRelativeNumber& prn = m_primeRels[index];
-                prn.SetToValue(num);
+                case ADD_CONST:
+                    item = AddMod(item, m_operand, m_modulus);
+                    break;
+                case MUL_CONST:
+                    item = MulMod(item, m_operand, m_modulus);
+                    break;
+                case SQUARE:
+                    item = MulMod(item, item, m_modulus);
+                    break;
+                case SET_CONST:
+                    item = m_operand;
+                    break;
+                default:
+                    assert(false);   // subtraction became addition when the modulus was set, and division can't happen
+                    break;
             }
-            return *this;
+            return ((item % m_testDivisor) == 0) ? m_throwToMonkeyIfTrue : m_throwToMonkeyIfFalse;
         }
 
-        bool IsDivisibleByPrime(BigInt prime) const
+        BigInt GetNumTimesInspected() const { return m_numTimesInspected; }
+
+    private:
+        BigInt m_monkeyIndex = 0;
+
+        Operation m_operation = ADD_CONST;
+        BigUInt m_operand = 0;
+
+        BigInt m_testDivisor = 1;
+        BigUInt m_modulus = 0;   // zero for part one, where worry decays instead
+        BigInt m_throwToMonkeyIfTrue = 0;
+        BigInt m_throwToMonkeyIfFalse = 0;
+
+        BigUIntList m_itemList;
+
+        BigInt m_numTimesInspected = 0;
+
+        // skips whitespace, then the given word too if it comes next, returning whether it did
+        static bool SkipWord(const char*& st, const char* word)
         {
-            const BigInt primeIndex = s_primeNumberToIndex[prime];
-            if (primeIndex < 0)
+            while (isspace(*st))
+                ++st;
+            const size_t wordLen = strlen(word);
+            if (strncmp(st, word, wordLen) != 0)
                 return false;
-            return m_primeRels[primeIndex].IsDivisible();
+            st += wordLen;
+            return true;
         }
 
-        void AddNumber(BigInt num)
-        {
-            for (BigInt index = Two; index < NUM_PRIMES; ++index)
-                m_primeRels[index].AddNumber(num);
-        }
-        void AddNumber(const ItemNumber& rhs)
+        // "old" or a constant
+        static bool ParseOperationArg(const char*& st, bool& isOld, BigInt& num)
         {
-            for (BigInt index = Two; index < NUM_PRIMES; ++index)
-                m_primeRels[index].AddNumber(rhs.m_primeRels[index]);
-        }
-        void MultiplyNumber(BigInt num)
-        {
-            for (BigInt index = Two; index < NUM_PRIMES; ++index)
-                m_primeRels[index].MultiplyNumber(num);
-        }
-        void MultiplyNumber(const ItemNumber& rhs)
-        {
-            for (BigInt index = Two; index < NUM_PRIMES; ++index)
-                m_primeRels[index].MultiplyNumber(rhs.m_primeRels[index]);
+            isOld = SkipWord(st, "old");
+            return isOld || ParseNextBigInt(st, num);
         }
 
-    private:
-        PrimeRelativeNumber m_primeRels[NUM_PRIMES];
-    };
-
-    class Monkey
-    {
-    public:
-        Monkey(const StringList& lines, BigInt startIndex, bool partTwo)
+        // boils the operation down to a single kind plus a constant operand
+        bool ParseOperation(const char* st)
         {
-            // monkey index
-
-            m_monkeyIndex = (BigInt)lines[startIndex + 0][7] - '0';
+            bool arg1IsOld = false;
+            BigInt arg1 = 0;
+            if (!ParseOperationArg(st, arg1IsOld, arg1))
+                return false;
 
-            StringList tokens;
+            while (isspace(*st))
+                ++st;
+            const char op = *st++;
+            if ((op != '+') && (op != '-') && (op != '*') && (op != '/'))
+                return false;
 
-            // starting items
+            bool arg2IsOld = false;
+            BigInt arg2 = 0;
+            if (!ParseOperationArg(st, arg2IsOld, arg2))
+                return false;
 
-            Tokenize(lines[startIndex + 1], tokens, ' ');
-            for (BigInt tokenIndex = 2; tokenIndex < (BigInt)tokens.size(); ++tokenIndex)
+            if (arg1IsOld && arg2IsOld)
             {
-                std::string& entry = tokens[tokenIndex];
-                if (entry[entry.length() - 1] == ',')
-                    entry.pop_back();
-                const BigInt num = atoll(entry.c_str());
-                if (!partTwo)
-                    m_itemList.push_back(num);
-                else
-                    m_itemList2.push_back(ItemNumber(num));
+                switch (op)
+                {
+                    case '+':
+                        m_operation = MUL_CONST;
+                        m_operand = 2;
+                        break;
+                    case '-':
+                        m_operation = SET_CONST;
+                        m_operand = 0;
+                        break;
+                    case '*':
+                        m_operation = SQUARE;
+                        break;
+                    case '/':
+                        m_operation = SET_CONST;
+                        m_operand = 1;
+                        break;
+                }
+            }
+            else if (arg1IsOld)
+            {
+                static const Operation s_constOperations[] = { ADD_CONST, SUB_CONST, MUL_CONST, DIV_CONST };
+                static const char s_constOperators[] = "+-*/";
+                m_operation = s_constOperations[strchr(s_constOperators, op) - s_constOperators];
+                m_operand = arg2;
+                if ((m_operation == DIV_CONST) && (arg2 == 0))
+                    return false;
+            }
+            else if (arg2IsOld)
+            {
+                // only the order-independent operations can have the constant first
+                if ((op != '+') && (op != '*'))
+                    return false;
+                m_operation = (op == '+') ? ADD_CONST : MUL_CONST;
+                m_operand = arg1;
             }
-
-            // operation
-
-            Tokenize(lines[startIndex + 2], tokens, ' ');
-            if (tokens[3] == "old")
-                m_operationArg1IsOld = true;
-            else if (partTwo)
-                m_operationArg1PartTwo = atoll(tokens[3].c_str());
-            else
-                m_operationArg1 = atoll(tokens[3].c_str());
-            m_operationIsAdd = (tokens[4] == "+");
-            if (tokens[5] == "old")
-                m_operationArg2IsOld = true;
-            else if (partTwo)
-                m_operationArg2PartTwo = atoll(tokens[5].c_str());
             else
-                m_operationArg2 = atoll(tokens[5].c_str());
+            {
+                if ((op == '/') && (arg2 == 0))
+                    return false;
+                m_operation = SET_CONST;
+                m_operand = (op == '+') ? (arg1 + arg2) : (op == '-') ? std::max(arg1 - arg2, 0LL) : (op == '*') ? (arg1 * arg2) : (arg1 / arg2);
+            }
 
-            // test
+            return true;
+        }
 
-            Tokenize(lines[startIndex + 3], tokens, ' ');
-            m_testDivisor = atoll(tokens[3].c_str());
+        // each kind of operation gets its own branch-free loop over the buffer, so the compiler can vectorize it
+        void ApplyOperationToAll()
+        {
+            BigUInt* items = m_itemList.data();
+            const BigInt numItems = m_itemList.size();
+            const BigUInt operand = m_operand;
 
-            Tokenize(lines[startIndex + 4], tokens, ' ');
-            m_throwToMonkeyIfTrue = atoll(tokens[5].c_str());
+            if (m_modulus > 0xFFFFFFFFULL)
+            {
+                // residues this big could overflow a plain multiply
+                for (BigInt i = 0; i < numItems; ++i)
+                    InspectItemPartTwo(items[i]);
+                return;
+            }
 
-            Tokenize(lines[startIndex + 5], tokens, ' ');
-            m_throwToMonkeyIfFalse = atoll(tokens[5].c_str());
+            switch (m_operation)
+            {
+                case ADD_CONST:
+                    for (BigInt i = 0; i < numItems; ++i)
+                        items[i] += operand;
+                    break;
+                case SUB_CONST:
+                    // only part one subtracts outright (part two turns it into an add); worry can't drop below zero
+                    for (BigInt i = 0; i < numItems; ++i)
+                        items[i] = (items[i] > operand) ? (items[i] - operand) : 0;
+                    break;
+                case MUL_CONST:
+                    for (BigInt i = 0; i < numItems; ++i)
+                        items[i] *= operand;
+                    break;
+                case DIV_CONST:
+                    for (BigInt i = 0; i < numItems; ++i)
+                        items[i] /= operand;
+                    break;
+                case SQUARE:
+                    for (BigInt i = 0; i < numItems; ++i)
+                        items[i] *= items[i];
+                    break;
+                case SET_CONST:
+                    for (BigInt i = 0; i < numItems; ++i)
+                        items[i] = operand;
+                    break;
+            }
+
+            if (m_modulus == 0)
+            {
+                // worry decay
+                for (BigInt i = 0; i < numItems; ++i)
+                    items[i] /= 3;
+            }
+            else
+            {
+                const BigUInt modulus = m_modulus;
+                for (BigInt i = 0; i < numItems; ++i)
+                    items[i] %= modulus;
+            }
         }
+    };
 
-        BigInt GetMonkeyIndex() const { return m_monkeyIndex; }
+    void RunOnData(const char* filename, BigInt numRounds, bool partTwo, bool verbose)
+    {
+        printf("For file '%s', num rounds = %lld, partTwo = %s\n", filename, numRounds, partTwo ? "YES" : "NO");
 
-        void GiveItem(BigInt newItem) { m_itemList.push_back(newItem); }
-        bool HasItemsToInspect() const { return !m_itemList.empty(); }
-        void InspectOneItem(BigInt& monkeyToThrowTo, BigInt& itemToThrow, bool verbose)
-        {
-            if (!HasItemsToInspect())
-                return;
+        StringList lines;
+        ReadFileLines(filename, lines);
 
-            BigInt currItem = m_itemList.front();
-            m_itemList.pop_front();
+        std::vector<Monkey> monkeyList;
+        if (!BuildMonkeyList(lines, partTwo, monkeyList))
+            return;
 
+        for (BigInt roundIndex = 0; roundIndex < numRounds; ++roundIndex)
+        {
             if (verbose)
-                printf("  Inspecting item %lld\n", currItem);
-
-            // operation
+                printf("***** Starting Round %lld *****\n\n", roundIndex + 1);
 
-            currItem = DoOperation(currItem, verbose);
+            for (Monkey& monkey: monkeyList)
+            {
+                if (verbose)
+                    printf("Monkey %lld:\n", monkey.GetMonkeyIndex());
 
-            // worry decay
+                monkey.TakeTurn(monkeyList, verbose);
+            }
+        }
 
+        if (verbose)
+            printf("\n\nMonkey inspection counts:\n");
+        BigIntList numInspectionsList;
+        for (const Monkey& monkey: monkeyList)
+        {
+            const BigInt numInspected = monkey.GetNumTimesInspected();
             if (verbose)
-                printf("    Worry level decays from %lld to %lld\n", currItem, currItem / 3);
-            currItem /= 3;
+                printf("  Monkey %lld inspected %lld times\n", monkey.GetMonkeyIndex(), numInspected);
+            numInspectionsList.push_back(numInspected);
+        }
 
-            // test
+        PrintTwoLargestInspectionsProduct(numInspectionsList);
+    }
 
-            const bool testResult = ((currItem % m_testDivisor) == 0);
-            if (verbose)
-                printf("    Testing is %lld divisible by %lld:  %s\n", currItem, m_testDivisor, testResult ? "TRUE" : "FALSE");
+    // Single pass over the lines, recognizing each by its leading word rather than its position, so any number of
+    // monkeys, blank lines and indentation are all fine.  Returns false for input it can't make sense of.
+    bool BuildMonkeyList(const StringList& lines, bool partTwo, std::vector<Monkey>& monkeyList)
+    {
+        monkeyList.clear();
 
-            // throwing
+        BigInt currMonkeyIndex = -1;
+        for (const std::string& line: lines)
+        {
+            const char* st = line.c_str();
+            while (isspace(*st))
+                ++st;
+            if (!*st)
+                continue;
 
-            monkeyToThrowTo = testResult ? m_throwToMonkeyIfTrue : m_throwToMonkeyIfFalse;
-            itemToThrow = currItem;
-            if (verbose)
-                printf("    Throwing value %lld to monkey %lld\n", itemToThrow, monkeyToThrowTo);
+            if (strncmp(st, "Monkey", 6) == 0)
+            {
+                if (!ParseNextBigInt(st, currMonkeyIndex))
+                    return false;
+                if (currMonkeyIndex >= (BigInt)monkeyList.size())
+                    monkeyList.resize(currMonkeyIndex + 1);
+                monkeyList[currMonkeyIndex].SetMonkeyIndex(currMonkeyIndex);
+                continue;
+            }
 
-            ++m_numTimesInspected;
+            if ((currMonkeyIndex < 0) || !monkeyList[currMonkeyIndex].ParseLine(st))
+            {
+                printf("Can't parse line '%s'\n", line.c_str());
+                return false;
+            }
         }
 
-        void GiveItemPartTwo(const ItemNumber& newItem) { m_itemList2.push_back(newItem); }
-        bool HasItemsToInspectPartTwo() const { return !m_itemList2.empty(); }
-        void InspectOneItemPartTwo(BigInt& monkeyToThrowTo, ItemNumber& itemToThrow, bool verbose)
+        for (const Monkey& monkey: monkeyList)
         {
-            if (!HasItemsToInspectPartTwo())
-                return;
+            for (BigInt throwTo: { monkey.GetThrowToMonkeyIfTrue(), monkey.GetThrowToMonkeyIfFalse() })
+            {
+                if ((throwTo < 0) || (throwTo >= (BigInt)monkeyList.size()) || (throwTo == monkey.GetMonkeyIndex()))
+                {
+                    printf("Monkey %lld can't throw to monkey %lld\n", monkey.GetMonkeyIndex(), throwTo);
+                    return false;
+                }
+            }
+        }
 
-            ItemNumber currItem = m_itemList2.front();
-            m_itemList2.pop_front();
+        if (partTwo)
+        {
+            BigUInt modulus = 1;
+            for (const Monkey& monkey: monkeyList)
+            {
+                if (monkey.GetOperation() == Monkey::DIV_CONST)
+                {
+                    printf("Monkey %lld divides, which can't be done on worry levels kept modulo the test divisors\n", monkey.GetMonkeyIndex());
+                    return false;
+                }
+                if (!CalcLeastCommonMultiple(modulus, (BigUInt)monkey.GetTestDivisor(), modulus))
+                {
+                    printf("The test divisors' least common multiple doesn't fit in 64 bits, so worry levels can't be kept modulo it\n");
+                    return false;
+                }
+            }
+            for (Monkey& monkey: monkeyList)
+                monkey.SetModulusPartTwo(modulus);
+        }
 
-            if (verbose)
-                printf("  Inspecting item\n");
+        return true;
+    }
 
-            // operation
+    void PrintTwoLargestInspectionsProduct(const BigIntList& numInspectionsList)
+    {
+        const BigIntSet numInspectionsSet(numInspectionsList.begin(), numInspectionsList.end());
 
-            currItem = DoOperation2(currItem, verbose);
+        auto setReverseIter = numInspectionsSet.crbegin();
+        const BigInt largestNumInspections = *setReverseIter;
+        ++setReverseIter;
+        const BigInt nextLargestNumInspections = *setReverseIter;
 
-            // test
+        if (largestNumInspections > MAX_BIG_INT / nextLargestNumInspections)
+        {
+            printf(
+                "\nProduct of two largest num inspections = %lld * %lld (too big to multiply out)\n\n",
+                largestNumInspections,
+                nextLargestNumInspections);
+            return;
+        }
 
-            const bool testResult = currItem.IsDivisibleByPrime(m_testDivisor);
-            if (verbose)
-                printf("    Testing is divisible by %lld:  %s\n", m_testDivisor, testResult ? "TRUE" : "FALSE");
+        const BigInt numInspectionsProduct = largestNumInspections * nextLargestNumInspections;
 
-            // throwing
+        printf(
+            "\nProduct of two largest num inspections = %lld * %lld = %lld\n\n",
+            largestNumInspections,
+            nextLargestNumInspections,
+            numInspectionsProduct);
+    }
 
-            monkeyToThrowTo = testResult ? m_throwToMonkeyIfTrue : m_throwToMonkeyIfFalse;
-            itemToThrow = currItem;
-            if (verbose)
-                printf("    Throwing value to monkey %lld\n", monkeyToThrowTo);
+    // Part two, but following each item on its own.  Items never affect each other, and an item's (holder, worry)
+    // state at the start of a round only has finitely many values, so every item's trajectory is eventually periodic.
+    // Brent's algorithm finds each cycle, and the inspections over the rounds it covers are counted once and multiplied
+    // out, so the number of rounds can be enormous.
+    void RunOnDataFastForward(const char* filename, BigInt numRounds, bool verbose)
+    {
+        printf("For file '%s', num rounds = %lld, fast forwarding each item\n", filename, numRounds);
 
-            ++m_numTimesInspected;
-        }
+        StringList lines;
+        ReadFileLines(filename, lines);
 
-        BigInt GetNumTimesInspected() const { return m_numTimesInspected; }
+        std::vector<Monkey> monkeyList;
+        if (!BuildMonkeyList(lines, true, monkeyList))
+            return;
 
-    private:
-        BigInt m_monkeyIndex = 0;
+        BigIntList numInspectionsList(monkeyList.size(), 0);
+        for (BigInt monkeyIndex = 0; monkeyIndex < (BigInt)monkeyList.size(); ++monkeyIndex)
+        {
+            for (BigUInt item: monkeyList[monkeyIndex].GetItems())
+            {
+                const ItemState startState = { monkeyIndex, item };
+                const BigInt cycleLength = AddItemInspections(monkeyList, startState, numRounds, numInspectionsList);
+                if (verbose)
+                    printf("  Item starting with monkey %lld has cycle length %lld\n", monkeyIndex, cycleLength);
+            }
+        }
 
-        bool m_operationIsAdd = false;
-        bool m_operationArg1IsOld = false;
-        BigInt m_operationArg1 = 0;
-        ItemNumber m_operationArg1PartTwo;
-        bool m_operationArg2IsOld = false;
-        BigInt m_operationArg2 = 0;
-        ItemNumber m_operationArg2PartTwo;
+        if (verbose)
+        {
+            printf("\n\nMonkey inspection counts:\n");
+            for (BigInt monkeyIndex = 0; monkeyIndex < (BigInt)monkeyList.size(); ++monkeyIndex)
+                printf("  Monkey %lld inspected %lld times\n", monkeyIndex, numInspectionsList[monkeyIndex]);
+        }
 
-        BigInt m_testDivisor = 1;
-        BigInt m_throwToMonkeyIfTrue = 0;
-        BigInt m_throwToMonkeyIfFalse = 0;
+        PrintTwoLargestInspectionsProduct(numInspectionsList);
+    }
 
-        BigIntDeque m_itemList;
-        typedef std::deque<ItemNumber> ItemNumberDeque;
-        ItemNumberDeque m_itemList2;
+    // Part two again, but with every item's whole round sequence simulated independently, spread across threads.  Items
+    // are split into a fixed set of chunks, each with its own per-monkey counters, and the chunks' counters are summed
+    // in order at the end, so the result is identical to the round-robin simulation.
+    void RunOnDataParallelItems(const char* filename, BigInt numRounds, bool verbose)
+    {
+        printf("For file '%s', num rounds = %lld, simulating items in parallel\n", filename, numRounds);
 
-        BigInt m_numTimesInspected = 0;
+        StringList lines;
+        ReadFileLines(filename, lines);
 
-        BigInt DoOperation(BigInt oldValue, bool verbose) const
-        {
-            const BigInt arg1 = m_operationArg1IsOld ? oldValue : m_operationArg1;
-            const BigInt arg2 = m_operationArg2IsOld ? oldValue : m_operationArg2;
+        std::vector<Monkey> monkeyList;
+        if (!BuildMonkeyList(lines, true, monkeyList))
+            return;
 
-            assert(arg1 >= 0);
-            assert(arg2 >= 0);
+        std::vector<ItemState> startStateList;
+        for (BigInt monkeyIndex = 0; monkeyIndex < (BigInt)monkeyList.size(); ++monkeyIndex)
+        {
+            for (BigUInt item: monkeyList[monkeyIndex].GetItems())
+                startStateList.push_back({ monkeyIndex, item });
+        }
 
-            const BigInt result = m_operationIsAdd ? (arg1 + arg2) : (arg1 * arg2);
+        static const BigInt ITEMS_PER_CHUNK = 16;
+        const BigInt numItems = startStateList.size();
+        const BigInt numChunks = (numItems + ITEMS_PER_CHUNK - 1) / ITEMS_PER_CHUNK;
 
-            assert(result >= 0);
+        BigIntListList chunkInspectionsList(numChunks, BigIntList(monkeyList.size(), 0));
+        ParallelFor(
+            numChunks,
+            [&](BigInt chunkIndex)
+            {
+                const BigInt endItemIndex = std::min((chunkIndex + 1) * ITEMS_PER_CHUNK, numItems);
+                for (BigInt itemIndex = chunkIndex * ITEMS_PER_CHUNK; itemIndex < endItemIndex; ++itemIndex)
+                    StepItemRounds(monkeyList, startStateList[itemIndex], numRounds, &chunkInspectionsList[chunkIndex]);
+            });
 
-            if (verbose)
-                printf(
-                    "    Doing operation:  %lld%s %s %lld%s = %lld\n",
-                    arg1,
-                    m_operationArg1IsOld ? " (old value)" : "",
-                    m_operationIsAdd ? "+" : "*",
-                    arg2,
-                    m_operationArg2IsOld ? " (old value)" : "",
-                    result);
-
-            return result;
+        BigIntList numInspectionsList(monkeyList.size(), 0);
+        for (const BigIntList& chunkInspections: chunkInspectionsList)
+        {
+            for (BigInt monkeyIndex = 0; monkeyIndex < (BigInt)monkeyList.size(); ++monkeyIndex)
+                numInspectionsList[monkeyIndex] += chunkInspections[monkeyIndex];
         }
 
-        ItemNumber DoOperation2(const ItemNumber& oldValue, bool verbose) const
+        if (verbose)
         {
-            const ItemNumber* arg1 = m_operationArg1IsOld ? &oldValue : &m_operationArg1PartTwo;
-            const ItemNumber* arg2 = m_operationArg2IsOld ? &oldValue : &m_operationArg2PartTwo;
+            printf("\n\nMonkey inspection counts:\n");
+            for (BigInt monkeyIndex = 0; monkeyIndex < (BigInt)monkeyList.size(); ++monkeyIndex)
+                printf("  Monkey %lld inspected %lld times\n", monkeyIndex, numInspectionsList[monkeyIndex]);
+        }
 
-            ItemNumber result = *arg1;
-            if (m_operationIsAdd)
-                result.AddNumber(*arg2);
-            else
-                result.MultiplyNumber(*arg2);
+        PrintTwoLargestInspectionsProduct(numInspectionsList);
+    }
 
-            return result;
-        }
+    struct ItemState
+    {
+        BigInt holder = 0;
+        BigUInt worry = 0;
+
+        bool operator==(const ItemState& rhs) const { return (holder == rhs.holder) && (worry == rhs.worry); }
+        bool operator!=(const ItemState& rhs) const { return !(*this == rhs); }
     };
 
-    void RunOnData(const char* filename, BigInt numRounds, bool partTwo, bool verbose)
+    // Monkeys take their turns in index order, so an item thrown to a later monkey gets inspected again that same round.
+    ItemState StepItemOneRound(const std::vector<Monkey>& monkeyList, ItemState state, BigIntList* numInspectionsList)
     {
-        printf("For file '%s', num rounds = %lld, partTwo = %s\n", filename, numRounds, partTwo ? "YES" : "NO");
+        for (;;)
+        {
+            const BigInt holder = state.holder;
+            if (numInspectionsList)
+                ++(*numInspectionsList)[holder];
 
-        StringList lines;
-        ReadFileLines(filename, lines);
+            state.holder = monkeyList[holder].InspectItemPartTwo(state.worry);
+            if (state.holder < holder)
+                return state;
+        }
+    }
 
-        std::vector<Monkey> monkeyList;
-        for (BigInt monkeyStartIndex = 0; monkeyStartIndex < (BigInt)lines.size(); monkeyStartIndex += 7)
-            monkeyList.emplace_back(lines, monkeyStartIndex, partTwo);
+    ItemState StepItemRounds(const std::vector<Monkey>& monkeyList, ItemState state, BigInt numRounds, BigIntList* numInspectionsList)
+    {
+        for (BigInt roundIndex = 0; roundIndex < numRounds; ++roundIndex)
+            state = StepItemOneRound(monkeyList, state, numInspectionsList);
+        return state;
+    }
 
-        if (!partTwo)
+    // Adds one item's inspections over numRounds rounds, and returns the length of its cycle (or -1 if simulating the
+    // rounds outright was cheaper than finding it)
+    BigInt AddItemInspections(
+        const std::vector<Monkey>& monkeyList, const ItemState& startState, BigInt numRounds, BigIntList& numInspectionsList)
+    {
+        // Brent's algorithm:  find the cycle length, giving up once that costs more steps than there are rounds
+
+        BigInt power = 1;
+        BigInt cycleLength = 1;
+        BigInt numSteps = 1;
+        ItemState tortoise = startState;
+        ItemState hare = StepItemOneRound(monkeyList, startState, nullptr);
+        while (tortoise != hare)
         {
-            for (BigInt roundIndex = 0; roundIndex < numRounds; ++roundIndex)
+            if (numSteps >= numRounds)
             {
-                if (verbose)
-                    printf("***** Starting Round %lld *****\n\n", roundIndex + 1);
+                StepItemRounds(monkeyList, startState, numRounds, &numInspectionsList);
+                return -1;
+            }
 
-                for (Monkey& monkey: monkeyList)
-                {
-                    if (verbose)
-                        printf("Monkey %lld:\n", monkey.GetMonkeyIndex());
-
-                    if (!monkey.HasItemsToInspect())
-                    {
-                        if (verbose)
-                            printf("  Monkey has no items to inspect\n");
-                        continue;
-                    }
-
-                    do
-                    {
-                        BigInt monkeyToThrowTo = 0;
-                        BigInt itemToThrow = 0;
-                        monkey.InspectOneItem(monkeyToThrowTo, itemToThrow, verbose);
-
-                        monkeyList[monkeyToThrowTo].GiveItem(itemToThrow);
-                    } while (monkey.HasItemsToInspect());
-                }
+            if (power == cycleLength)
+            {
+                tortoise = hare;
+                power *= 2;
+                cycleLength = 0;
             }
+            hare = StepItemOneRound(monkeyList, hare, nullptr);
+            ++cycleLength;
+            ++numSteps;
         }
-        else
-        {
-            for (BigInt roundIndex = 0; roundIndex < numRounds; ++roundIndex)
-            {
-                if (verbose)
-                    printf("***** Starting Round %lld *****\n\n", roundIndex + 1);
 
-                for (Monkey& monkey: monkeyList)
-                {
-                    if (verbose)
-                        printf("Monkey %lld:\n", monkey.GetMonkeyIndex());
-
-                    if (!monkey.HasItemsToInspectPartTwo())
-                    {
-                        if (verbose)
-                            printf("  Monkey has no items to inspect\n");
-                        continue;
-                    }
-
-                    do
-                    {
-                        BigInt monkeyToThrowTo = 0;
-                        ItemNumber itemToThrow = 0;
-                        monkey.InspectOneItemPartTwo(monkeyToThrowTo, itemToThrow, verbose);
-
-                        monkeyList[monkeyToThrowTo].GiveItemPartTwo(itemToThrow);
-                    } while (monkey.HasItemsToInspectPartTwo());
-                }
-            }
+        // then the length of the tail leading into the cycle
+
+        BigInt tailLength = 0;
+        tortoise = startState;
+        hare = StepItemRounds(monkeyList, startState, cycleLength, nullptr);
+        while (tortoise != hare)
+        {
+            tortoise = StepItemOneRound(monkeyList, tortoise, nullptr);
+            hare = StepItemOneRound(monkeyList, hare, nullptr);
+            ++tailLength;
         }
 
-        if (verbose)
-            printf("\n\nMonkey inspection counts:\n");
-        BigIntSet numInspectionsSet;
-        for (const Monkey& monkey: monkeyList)
+        if (numRounds <= tailLength + cycleLength)
         {
-            const BigInt numInspected = monkey.GetNumTimesInspected();
-            if (verbose)
-                printf("  Monkey %lld inspected %lld times\n", monkey.GetMonkeyIndex(), numInspected);
-            numInspectionsSet.insert(numInspected);
+            StepItemRounds(monkeyList, startState, numRounds, &numInspectionsList);
+            return cycleLength;
         }
 
-        auto setReverseIter = numInspectionsSet.crbegin();
-        const BigInt largestNumInspections = *setReverseIter;
-        ++setReverseIter;
-        const BigInt nextLargestNumInspections = *setReverseIter;
-        const BigInt numInspectionsProduct = largestNumInspections * nextLargestNumInspections;
+        // count the tail and one trip around the cycle, then multiply the cycle out
 
-        printf(
-            "\nProduct of two largest num inspections = %lld * %lld = %lld\n\n",
-            largestNumInspections,
-            nextLargestNumInspections,
-            numInspectionsProduct);
-    }
-};
+        const ItemState cycleStartState = StepItemRounds(monkeyList, startState, tailLength, &numInspectionsList);
+
+        BigIntList cycleInspectionsList(numInspectionsList.size(), 0);
+        StepItemRounds(monkeyList, cycleStartState, cycleLength, &cycleInspectionsList);
 
-const BigInt Problem11::s_primeNumbers[NUM_PRIMES] = { 2, 3, 5, 7, 11, 13, 17, 19, 23 };
-const BigInt Problem11::s_primeNumberToIndex[MAX_PRIME] = { -1, -1,        Two, Three,    -1, Five,     -1, Seven,
-                                                            -1, -1,        -1,  Eleven,   -1, Thirteen, -1, -1,
-                                                            -1, Seventeen, -1,  Nineteen, -1, -1,       -1, TwentyThree };
+        const BigInt numCycles = (numRounds - tailLength) / cycleLength;
+        const BigInt numLeftoverRounds = (numRounds - tailLength) % cycleLength;
+        for (BigInt monkeyIndex = 0; monkeyIndex < (BigInt)numInspectionsList.size(); ++monkeyIndex)
+            numInspectionsList[monkeyIndex] += cycleInspectionsList[monkeyIndex] * numCycles;
 
+        StepItemRounds(monkeyList, cycleStartState, numLeftoverRounds, &numInspectionsList);
+
+        return cycleLength;
+    }
+};
 
 Problem11 problem11;
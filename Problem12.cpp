@@ -23,17 +23,326 @@ private:
         SOUTH,
     };
 
-    struct Node
+    // Structure-of-arrays board, one byte per node, in a single allocation padded with a border ring so that
+    // neighbor checks never need bounds tests:
+    //   bits 0-4:  elevation (BORDER_ELEVATION marks the padding)
+    //   bits 5-6:  direction the shortest path entered from
+    //   bit 7:     whether the entered-from direction is set
+    // Shortest path distances are only allocated once something asks for them.
+    class Board
     {
-        BigInt elevation = 0;
-        bool isGoal = false;
-        BigInt shortestPathEnteredFromDir = -1;
-        BigInt shortestPathToHere = -1;
-        BigInt shortestPathExitingDir = -1;
+    public:
+        static const BigInt BORDER_ELEVATION = 31;
+        static const BigInt MAX_ELEVATION = BORDER_ELEVATION - 1;
+
+        void Init(BigInt width, BigInt height)
+        {
+            m_width = width;
+            m_height = height;
+            m_stride = width + 2;
+            m_goalIndex = -1;
+
+            m_cellList.clear();
+            m_cellList.resize(m_stride * (height + 2), (uint8_t)BORDER_ELEVATION);
+            for (BigInt y = 0; y < height; ++y)
+            {
+                for (BigInt x = 0; x < width; ++x)
+                    m_cellList[ToIndex(x, y)] = 0;
+            }
+
+            m_distList.clear();
+        }
+
+        BigInt GetWidth() const { return m_width; }
+        BigInt GetHeight() const { return m_height; }
+        BigInt GetStride() const { return m_stride; }
+
+        // indices are into the padded storage, so stepping one off the edge lands on the border ring
+        BigInt ToIndex(BigInt x, BigInt y) const { return (y + 1) * m_stride + (x + 1); }
+        BigInt IndexToX(BigInt index) const { return (index % m_stride) - 1; }
+        BigInt IndexToY(BigInt index) const { return (index / m_stride) - 1; }
+        BigInt GetIndexStep(BigInt dir) const
+        {
+            BigInt stepX = 0;
+            BigInt stepY = 0;
+            GetDirSteps(dir, stepX, stepY);
+            return stepY * m_stride + stepX;
+        }
+
+        bool IsBorder(BigInt index) const { return GetElevation(index) == BORDER_ELEVATION; }
+
+        BigInt GetElevation(BigInt index) const { return m_cellList[index] & ELEVATION_MASK; }
+        void SetElevation(BigInt index, BigInt elevation)
+        {
+            assert((elevation >= 0) && (elevation <= MAX_ELEVATION));
+            m_cellList[index] = (uint8_t)((m_cellList[index] & ~ELEVATION_MASK) | elevation);
+        }
+
+        BigInt GetEnteredFromDir(BigInt index) const
+        {
+            const uint8_t cell = m_cellList[index];
+            return (cell & HAS_DIR_BIT) ? ((cell >> DIR_SHIFT) & 3) : -1;
+        }
+        void SetEnteredFromDir(BigInt index, BigInt dir)
+        {
+            assert((dir >= 0) && (dir <= 3));
+            m_cellList[index] = (uint8_t)((m_cellList[index] & ELEVATION_MASK) | HAS_DIR_BIT | (dir << DIR_SHIFT));
+        }
+
+        bool IsGoal(BigInt index) const { return index == m_goalIndex; }
+        void SetGoal(BigInt index) { m_goalIndex = index; }
+
+        BigInt GetShortestPathToHere(BigInt index) const
+        {
+            if (m_distList.empty() || (m_distList[index] == NO_DIST))
+                return -1;
+            return m_distList[index];
+        }
+        void SetShortestPathToHere(BigInt index, BigInt dist)
+        {
+            if (m_distList.empty())
+                m_distList.resize(m_cellList.size(), (uint32_t)NO_DIST);
+            m_distList[index] = (uint32_t)dist;
+        }
+
+    private:
+        static const uint8_t ELEVATION_MASK = 0x1F;
+        static const uint8_t DIR_SHIFT = 5;
+        static const uint8_t HAS_DIR_BIT = 0x80;
+        static const uint32_t NO_DIST = UINT32_MAX;
+
+        BigInt m_width = 0;
+        BigInt m_height = 0;
+        BigInt m_stride = 0;
+        BigInt m_goalIndex = -1;
+        std::vector<uint8_t> m_cellList;
+        std::vector<uint32_t> m_distList;
     };
 
-    typedef std::vector<Node> BoardRow;
-    typedef std::vector<BoardRow> Board;
+    // Distance (in steps) from every node to the goal, along valid forward moves.  After the initial full build,
+    // single-node elevation edits are repaired in place, touching only the nodes whose distance actually changes
+    // (in the spirit of Ramalingam-Reps dynamic shortest paths).
+    class DistanceField
+    {
+    public:
+        void Build(const Board& board, BigInt endX, BigInt endY)
+        {
+            m_goalIndex = board.ToIndex(endX, endY);
+
+            m_distList.clear();
+            m_distList.resize(board.GetStride() * (board.GetHeight() + 2), -1);
+            m_affectedList.clear();
+            m_affectedList.resize(m_distList.size(), false);
+
+            // plain reverse BFS from the goal
+            BigIntDeque queue;
+            m_distList[m_goalIndex] = 0;
+            queue.push_back(m_goalIndex);
+            while (!queue.empty())
+            {
+                const BigInt index = queue.front();
+                queue.pop_front();
+
+                BigInt neighborList[4];
+                const BigInt numNeighbors = GetPredecessors(board, index, neighborList);
+                for (BigInt i = 0; i < numNeighbors; ++i)
+                {
+                    const BigInt prevIndex = neighborList[i];
+                    if (m_distList[prevIndex] >= 0)
+                        continue;
+
+                    m_distList[prevIndex] = m_distList[index] + 1;
+                    queue.push_back(prevIndex);
+                }
+            }
+
+            m_numNodesRepaired = 0;
+        }
+
+        BigInt GetDist(const Board& board, BigInt x, BigInt y) const { return m_distList[board.ToIndex(x, y)]; }
+        BigInt GetNumNodesRepaired() const { return m_numNodesRepaired; }
+
+        // shortest path from any node of elevation 0 to the goal, or -1 if none can reach it
+        BigInt FindShortestDistFromLowest(const Board& board, BigInt& bestX, BigInt& bestY) const
+        {
+            BigInt shortestDist = -1;
+            for (BigInt index = 0; index < (BigInt)m_distList.size(); ++index)
+            {
+                const BigInt dist = m_distList[index];
+                if ((dist < 0) || (board.GetElevation(index) != 0))
+                    continue;
+                if ((shortestDist < 0) || (dist < shortestDist))
+                {
+                    shortestDist = dist;
+                    bestX = board.IndexToX(index);
+                    bestY = board.IndexToY(index);
+                }
+            }
+            return shortestDist;
+        }
+
+        // sets a node's elevation and repairs the distance field around it
+        void ChangeElevation(Board& board, BigInt x, BigInt y, BigInt newElevation)
+        {
+            m_numNodesRepaired = 0;
+
+            const BigInt changedIndex = board.ToIndex(x, y);
+            if (board.GetElevation(changedIndex) == newElevation)
+                return;
+            board.SetElevation(changedIndex, newElevation);
+
+            // the only moves that changed are the ones into and out of this node, so it and its neighbors are the
+            // only nodes whose best next step may have vanished or whose distance may have dropped
+            BigIntList candidateList;
+            candidateList.push_back(changedIndex);
+            for (BigInt dir = WEST; dir <= SOUTH; ++dir)
+            {
+                const BigInt neighborIndex = changedIndex + board.GetIndexStep(dir);
+                if (!board.IsBorder(neighborIndex))
+                    candidateList.push_back(neighborIndex);
+            }
+
+            // phase one:  find every node that lost all of its shortest-path next steps, spreading backwards from the
+            // candidates to any node that depended on an affected one
+
+            BigIntList affectedIndexList;
+            BigIntDeque checkQueue(candidateList.begin(), candidateList.end());
+            while (!checkQueue.empty())
+            {
+                const BigInt index = checkQueue.front();
+                checkQueue.pop_front();
+
+                if ((index == m_goalIndex) || m_affectedList[index] || (m_distList[index] < 0))
+                    continue;
+                if (HasShortestNextStep(board, index))
+                    continue;
+
+                m_affectedList[index] = true;
+                affectedIndexList.push_back(index);
+
+                BigInt neighborList[4];
+                const BigInt numNeighbors = GetPredecessors(board, index, neighborList);
+                for (BigInt i = 0; i < numNeighbors; ++i)
+                {
+                    const BigInt prevIndex = neighborList[i];
+                    if (m_distList[prevIndex] == m_distList[index] + 1)
+                        checkQueue.push_back(prevIndex);
+                }
+            }
+
+            for (BigInt index: affectedIndexList)
+                m_distList[index] = -1;
+
+            // phase two:  seed the affected nodes and the candidates with the best distance their unaffected neighbors
+            // offer, then relax outward in distance order until nothing improves
+
+            std::set<std::pair<BigInt, BigInt>> repairQueue;
+            for (BigInt index: affectedIndexList)
+            {
+                m_affectedList[index] = false;
+                SeedFromNextSteps(board, index, repairQueue);
+            }
+            for (BigInt index: candidateList)
+            {
+                if (index != m_goalIndex)
+                    SeedFromNextSteps(board, index, repairQueue);
+            }
+
+            while (!repairQueue.empty())
+            {
+                const BigInt dist = repairQueue.begin()->first;
+                const BigInt index = repairQueue.begin()->second;
+                repairQueue.erase(repairQueue.begin());
+                ++m_numNodesRepaired;
+
+                BigInt neighborList[4];
+                const BigInt numNeighbors = GetPredecessors(board, index, neighborList);
+                for (BigInt i = 0; i < numNeighbors; ++i)
+                {
+                    const BigInt prevIndex = neighborList[i];
+                    BigInt& prevDist = m_distList[prevIndex];
+                    if ((prevDist >= 0) && (prevDist <= dist + 1))
+                        continue;
+
+                    if (prevDist >= 0)
+                        repairQueue.erase(std::make_pair(prevDist, prevIndex));
+                    prevDist = dist + 1;
+                    repairQueue.emplace(prevDist, prevIndex);
+                }
+            }
+        }
+
+    private:
+        BigInt m_goalIndex = -1;
+        BigIntList m_distList;
+        BoolList m_affectedList;
+        BigInt m_numNodesRepaired = 0;
+
+        static bool CanStep(BigInt fromElevation, BigInt toElevation) { return (toElevation - fromElevation) <= 1; }
+
+        // neighbors that can step INTO this node
+        BigInt GetPredecessors(const Board& board, BigInt index, BigInt* neighborList) const
+        {
+            const BigInt elevation = board.GetElevation(index);
+            BigInt numNeighbors = 0;
+            for (BigInt dir = WEST; dir <= SOUTH; ++dir)
+            {
+                const BigInt neighborIndex = index + board.GetIndexStep(dir);
+                if (!board.IsBorder(neighborIndex) && CanStep(board.GetElevation(neighborIndex), elevation))
+                    neighborList[numNeighbors++] = neighborIndex;
+            }
+            return numNeighbors;
+        }
+
+        // neighbors this node can step OUT to
+        BigInt GetSuccessors(const Board& board, BigInt index, BigInt* neighborList) const
+        {
+            const BigInt elevation = board.GetElevation(index);
+            BigInt numNeighbors = 0;
+            for (BigInt dir = WEST; dir <= SOUTH; ++dir)
+            {
+                const BigInt neighborIndex = index + board.GetIndexStep(dir);
+                if (!board.IsBorder(neighborIndex) && CanStep(elevation, board.GetElevation(neighborIndex)))
+                    neighborList[numNeighbors++] = neighborIndex;
+            }
+            return numNeighbors;
+        }
+
+        bool HasShortestNextStep(const Board& board, BigInt index) const
+        {
+            BigInt neighborList[4];
+            const BigInt numNeighbors = GetSuccessors(board, index, neighborList);
+            for (BigInt i = 0; i < numNeighbors; ++i)
+            {
+                const BigInt nextIndex = neighborList[i];
+                if (!m_affectedList[nextIndex] && (m_distList[nextIndex] >= 0) && (m_distList[nextIndex] == m_distList[index] - 1))
+                    return true;
+            }
+            return false;
+        }
+
+        void SeedFromNextSteps(const Board& board, BigInt index, std::set<std::pair<BigInt, BigInt>>& repairQueue)
+        {
+            BigInt bestDist = -1;
+            BigInt neighborList[4];
+            const BigInt numNeighbors = GetSuccessors(board, index, neighborList);
+            for (BigInt i = 0; i < numNeighbors; ++i)
+            {
+                const BigInt nextDist = m_distList[neighborList[i]];
+                if ((nextDist >= 0) && ((bestDist < 0) || (nextDist + 1 < bestDist)))
+                    bestDist = nextDist + 1;
+            }
+
+            BigInt& dist = m_distList[index];
+            if ((bestDist < 0) || ((dist >= 0) && (dist <= bestDist)))
+                return;
+
+            if (dist >= 0)
+                repairQueue.erase(std::make_pair(dist, index));
+            dist = bestDist;
+            repairQueue.emplace(dist, index);
+        }
+    };
 
     void RunOnData(const char* filename, bool verbose)
     {
@@ -58,25 +367,108 @@ private:
 
         shortestPath = -1;
         FindShortestPathPartTwo(board, endX, endY, shortestPath, verbose);
+
+        // What-if edits on a distance field
+
+        RunWhatIfEdits(board, startX, startY, endX, endY, verbose);
+    }
+
+    void RunWhatIfEdits(Board& board, BigInt startX, BigInt startY, BigInt endX, BigInt endY, bool verbose)
+    {
+        DistanceField distField;
+        distField.Build(board, endX, endY);
+
+        BigInt lowestX = 0;
+        BigInt lowestY = 0;
+        printf(
+            "Distance field:  from start = %lld, from lowest = %lld\n",
+            distField.GetDist(board, startX, startY),
+            distField.FindShortestDistFromLowest(board, lowestX, lowestY));
+
+        // wall off the node halfway along the path from the start, then put it back
+
+        const BigInt halfwayDist = distField.GetDist(board, startX, startY) / 2;
+        BigInt x = startX;
+        BigInt y = startY;
+        while (distField.GetDist(board, x, y) > halfwayDist)
+        {
+            for (BigInt dir = WEST; dir <= SOUTH; ++dir)
+            {
+                BigInt stepX = 0;
+                BigInt stepY = 0;
+                GetDirSteps(dir, stepX, stepY);
+                if (IsPosValid(board, x + stepX, y + stepY)
+                    && ((board.GetElevation(board.ToIndex(x + stepX, y + stepY)) - board.GetElevation(board.ToIndex(x, y))) <= 1)
+                    && (distField.GetDist(board, x + stepX, y + stepY) == distField.GetDist(board, x, y) - 1))
+                {
+                    x += stepX;
+                    y += stepY;
+                    break;
+                }
+            }
+        }
+
+        const BigInt origElevation = board.GetElevation(board.ToIndex(x, y));
+        const BigInt origDistFromStart = distField.GetDist(board, startX, startY);
+
+        distField.ChangeElevation(board, x, y, (BigInt)'z' - 'a' + 2);
+        printf(
+            "  Raising <%lld,%lld> out of reach:  from start = %lld (%lld nodes repaired)\n",
+            x,
+            y,
+            distField.GetDist(board, startX, startY),
+            distField.GetNumNodesRepaired());
+        if (verbose)
+            CheckDistanceField(distField, board, endX, endY);
+
+        distField.ChangeElevation(board, x, y, origElevation);
+        printf(
+            "  Restoring <%lld,%lld>:  from start = %lld (%lld nodes repaired)\n",
+            x,
+            y,
+            distField.GetDist(board, startX, startY),
+            distField.GetNumNodesRepaired());
+        if (distField.GetDist(board, startX, startY) != origDistFromStart)
+            printf("  Restored distance from start doesn't match the original %lld!\n", origDistFromStart);
+        if (verbose)
+            CheckDistanceField(distField, board, endX, endY);
+        printf("\n");
+    }
+
+    void CheckDistanceField(const DistanceField& distField, const Board& board, BigInt endX, BigInt endY)
+    {
+        DistanceField rebuiltField;
+        rebuiltField.Build(board, endX, endY);
+        BigInt numMismatches = 0;
+        for (BigInt y = 0; y < board.GetHeight(); ++y)
+        {
+            for (BigInt x = 0; x < board.GetWidth(); ++x)
+            {
+                if (distField.GetDist(board, x, y) != rebuiltField.GetDist(board, x, y))
+                    ++numMismatches;
+            }
+        }
+
+        if (numMismatches == 0)
+            printf("  Distance field matches a full rebuild\n");
+        else
+            printf("  Distance field DOESN'T match a full rebuild at %lld locations!\n", numMismatches);
     }
 
     void BuildBoardFromLines(const StringList& lines, Board& board, BigInt& startX, BigInt& startY, BigInt& endX, BigInt& endY)
     {
-        board.clear();
-        board.resize(lines.size());
+        board.Init(lines.empty() ? 0 : lines[0].length(), lines.size());
 
         for (BigInt y = 0; y < (BigInt)lines.size(); ++y)
         {
             const std::string& line = lines[y];
-            BoardRow& boardRow = board[y];
-            boardRow.clear();
-            boardRow.resize(line.length());
+            assert((BigInt)line.length() == board.GetWidth());
 
             for (BigInt x = 0; x < (BigInt)line.length(); ++x)
             {
                 const char ch = line[x];
 
-                Node& node = boardRow[x];
+                const BigInt index = board.ToIndex(x, y);
                 if (ch == 'S')
                 {
                     startX = x;
@@ -86,12 +478,12 @@ private:
                 {
                     endX = x;
                     endY = y;
-                    node.elevation = (BigInt)'z' - 'a';
-                    node.isGoal = true;
+                    board.SetElevation(index, (BigInt)'z' - 'a');
+                    board.SetGoal(index);
                 }
                 else
                 {
-                    node.elevation = (BigInt)ch - 'a';
+                    board.SetElevation(index, (BigInt)ch - 'a');
                 }
             }
         }
@@ -112,7 +504,7 @@ private:
         printf("Found shortest path = %lld\n\n", shortestPath);
 
         if (verbose)
-            MarkUpAndShowShortestPath(board, startX, startY, endX, endY);
+            ShowShortestPath(board, startX, startY, endX, endY);
     }
 
     void FindShortestPathPartTwo(
@@ -128,7 +520,7 @@ private:
         printf("Found shortest path = %lld, to location <%lld,%lld>\n\n", shortestPath, goalX, goalY);
 
         if (verbose)
-            MarkUpAndShowShortestPath(board, startX, startY, goalX, goalY);
+            ShowShortestPath(board, startX, startY, goalX, goalY);
     }
 
     void RecursiveExplore(
@@ -145,18 +537,20 @@ private:
     {
         if (verbose)
             printf("  Exploring node <%lld,%lld>\n", x, y);
-        
-        Node& currNode = board[y][x];
+
+        const BigInt currIndex = board.ToIndex(x, y);
+        const BigInt currElevation = board.GetElevation(currIndex);
         if (dirEntered >= 0)
         {
             // check and update path length
-            if ((currNode.shortestPathToHere < 0) || (pathLengthSoFar < currNode.shortestPathToHere))
+            const BigInt shortestPathToHere = board.GetShortestPathToHere(currIndex);
+            if ((shortestPathToHere < 0) || (pathLengthSoFar < shortestPathToHere))
             {
-                currNode.shortestPathToHere = pathLengthSoFar;
-                currNode.shortestPathEnteredFromDir = dirEntered;
+                board.SetShortestPathToHere(currIndex, pathLengthSoFar);
+                board.SetEnteredFromDir(currIndex, dirEntered);
 
-                if ((!isReversePath && currNode.isGoal)
-                    || (isReversePath && (currNode.elevation == 0) && ((shortestPath < 0) || (pathLengthSoFar < shortestPath))))
+                if ((!isReversePath && board.IsGoal(currIndex))
+                    || (isReversePath && (currElevation == 0) && ((shortestPath < 0) || (pathLengthSoFar < shortestPath))))
                 {
                     // we found one way to the goal
                     shortestPath = pathLengthSoFar;
@@ -197,12 +591,12 @@ private:
                 continue;
             }
 
-            const BigInt nextElevation = board[nextY][nextX].elevation;
-            const BigInt nextElevationDiff = nextElevation - currNode.elevation;
+            const BigInt nextElevation = board.GetElevation(board.ToIndex(nextX, nextY));
+            const BigInt nextElevationDiff = nextElevation - currElevation;
             if ((!isReversePath && (nextElevationDiff > 1)) || (isReversePath && (nextElevationDiff < -1)))
             {
                 if (verbose)
-                    printf("      Node's elevation %lld is too %s compared with current elevation %lld, skipping...\n", nextElevation, isReversePath ? "LOW" : "HIGH", currNode.elevation);
+                    printf("      Node's elevation %lld is too %s compared with current elevation %lld, skipping...\n", nextElevation, isReversePath ? "LOW" : "HIGH", currElevation);
                 continue;
             }
 
@@ -220,15 +614,18 @@ private:
         }
     }
 
-    void MarkUpAndShowShortestPath(Board& board, BigInt startX, BigInt startY, BigInt endX, BigInt endY)
+    void ShowShortestPath(const Board& board, BigInt startX, BigInt startY, BigInt endX, BigInt endY)
     {
-        // first trace back through the shortest path, marking the way
+        // lay out the display, then trace back through the shortest path, marking the way
+
+        StringList display;
+        display.resize(board.GetHeight(), std::string(board.GetWidth(), '.'));
 
         BigInt x = endX;
         BigInt y = endY;
         do
         {
-            const BigInt dirBack = board[y][x].shortestPathEnteredFromDir;
+            const BigInt dirBack = board.GetEnteredFromDir(board.ToIndex(x, y));
             assert(dirBack >= 0);
 
             BigInt stepX = 0;
@@ -238,74 +635,27 @@ private:
 
             x += stepX;
             y += stepY;
-            board[y][x].shortestPathExitingDir = GetOppositeDir(dirBack);
+
+            static const char s_exitingDirChars[] = { '<', '^', '>', 'V' };
+            display[y][x] = s_exitingDirChars[GetOppositeDir(dirBack)];
         } while ((x != startX) || (y != startY));
 
+        display[startY][startX] = 'S';
+        display[endY][endX] = 'E';
+
         // now show the way
 
         printf("Board showing path:\n\n");
 
-        for (BigInt y = 0; y < (BigInt)board.size(); ++y)
-        {
-            printf("  ");
-            const BoardRow& boardRow = board[y];
-            for (BigInt x = 0; x < (BigInt)boardRow.size(); ++x)
-            {
-                const Node& node = boardRow[x];
-                if ((x == startX) && (y == startY))
-                {
-                    printf("S");
-                }
-                else if ((x == endX) && (y == endY))
-                {
-                    printf("E");
-                }
-                else if (node.shortestPathExitingDir >= 0)
-                {
-                    switch (node.shortestPathExitingDir)
-                    {
-                        case WEST:
-                            printf("<");
-                            break;
-                        case NORTH:
-                            printf("^");
-                            break;
-                        case EAST:
-                            printf(">");
-                            break;
-                        case SOUTH:
-                            printf("V");
-                            break;
-                        default:
-                            printf("?");
-                            break;
-                    }
-                }
-                else
-                {
-                    printf(".");
-                }
-            }
-            printf("\n");
-        }
+        for (const std::string& displayRow: display)
+            printf("  %s\n", displayRow.c_str());
         printf("\n");
     }
 
     static BigInt QuickMod4(BigInt input) { return input & 3; }
 
-    static bool IsPosValid(const Board& board, BigInt x, BigInt y)
-    {
-        if (x < 0)
-            return false;
-        if (x >= (BigInt)board[0].size())
-            return false;
-        if (y < 0)
-            return false;
-        if (y >= (BigInt)board.size())
-            return false;
-
-        return true;
-    }
+    // only valid for positions at most one step off the board, which is all that neighbor checks ever produce
+    static bool IsPosValid(const Board& board, BigInt x, BigInt y) { return !board.IsBorder(board.ToIndex(x, y)); }
 
     static const char* GetDirName(BigInt dir)
     {
@@ -15,14 +15,136 @@ public:
     }
 
 private:
-    static const BigInt MAX_GRID_SIZE = 1024;
-    typedef std::vector<std::string> Board;
+    // Unbounded board, stored as square tiles that are only allocated once something is placed in them, so memory
+    // tracks the touched area rather than the coordinate range.  Each tile keeps a row of bits per cell kind.
+    class Board
+    {
+    public:
+        static const BigInt TILE_SIZE = 64;
+
+        enum CellKind
+        {
+            ROCK,
+            SAND,
+            PATH,
+            NUM_CELL_KINDS,
+        };
+
+        // an endless row of rock, or MAX_BIG_INT for no floor
+        void SetFloorY(BigInt floorY) { m_floorY = floorY; }
+
+        bool IsBlocked(BigInt x, BigInt y) const
+        {
+            if (y == m_floorY)
+                return true;
+
+            const Tile* tile = FindTile(ToTileCoord(x), ToTileCoord(y));
+            if (!tile)
+                return false;
+
+            const BigUInt cellBit = 1ULL << (x - ToTileCoord(x) * TILE_SIZE);
+            const BigInt localY = y - ToTileCoord(y) * TILE_SIZE;
+            return ((tile->bitRows[ROCK][localY] | tile->bitRows[SAND][localY]) & cellBit) != 0;
+        }
+
+        bool HasCell(BigInt x, BigInt y, CellKind kind) const
+        {
+            if ((kind == ROCK) && (y == m_floorY))
+                return true;
+
+            const Tile* tile = FindTile(ToTileCoord(x), ToTileCoord(y));
+            if (!tile)
+                return false;
+
+            return (tile->bitRows[kind][y - ToTileCoord(y) * TILE_SIZE] & (1ULL << (x - ToTileCoord(x) * TILE_SIZE))) != 0;
+        }
+
+        void SetCell(BigInt x, BigInt y, CellKind kind)
+        {
+            Tile& tile = FindOrAddTile(ToTileCoord(x), ToTileCoord(y));
+            tile.bitRows[kind][y - ToTileCoord(y) * TILE_SIZE] |= 1ULL << (x - ToTileCoord(x) * TILE_SIZE);
+        }
+
+        // one tile-wide row of rock bits, bit 0 being the tile's leftmost column (the floor is not included).
+        // Skips the last-tile cache, so it is safe to call from several threads at once.
+        BigUInt GetRockRowBits(BigInt tileX, BigInt y) const
+        {
+            auto iter = m_tileKeyToIndexMap.find(MakeTileKey(tileX, ToTileCoord(y)));
+            if (iter == m_tileKeyToIndexMap.end())
+                return 0;
+            return m_tileList[iter->second].bitRows[ROCK][y - ToTileCoord(y) * TILE_SIZE];
+        }
+
+        void AddRowBits(BigInt tileX, BigInt y, CellKind kind, BigUInt bits)
+        {
+            Tile& tile = FindOrAddTile(tileX, ToTileCoord(y));
+            tile.bitRows[kind][y - ToTileCoord(y) * TILE_SIZE] |= bits;
+        }
+
+        BigInt GetNumTiles() const { return m_tileList.size(); }
+
+        // floor division, so negative coordinates land in their own tiles too
+        static BigInt ToTileCoord(BigInt coord) { return (coord >= 0) ? (coord / TILE_SIZE) : -((-coord + TILE_SIZE - 1) / TILE_SIZE); }
+
+    private:
+        struct Tile
+        {
+            BigUInt bitRows[NUM_CELL_KINDS][TILE_SIZE] = {};
+        };
+
+        std::vector<Tile> m_tileList;
+        BigIntUnorderedMap m_tileKeyToIndexMap;
+        BigInt m_floorY = MAX_BIG_INT;
+
+        // grains mostly fall within one tile, so remember the last one looked up
+        mutable BigInt m_lastTileKey = MAX_BIG_INT;
+        mutable BigInt m_lastTileIndex = -1;
+
+        static BigInt MakeTileKey(BigInt tileX, BigInt tileY) { return (tileY << 32) ^ (tileX & 0xFFFFFFFFLL); }
+
+        const Tile* FindTile(BigInt tileX, BigInt tileY) const
+        {
+            const BigInt tileKey = MakeTileKey(tileX, tileY);
+            if (tileKey != m_lastTileKey)
+            {
+                auto iter = m_tileKeyToIndexMap.find(tileKey);
+                if (iter == m_tileKeyToIndexMap.end())
+                    return nullptr;
+
+                m_lastTileKey = tileKey;
+                m_lastTileIndex = iter->second;
+            }
+            return &m_tileList[m_lastTileIndex];
+        }
+
+        Tile& FindOrAddTile(BigInt tileX, BigInt tileY)
+        {
+            if (!FindTile(tileX, tileY))
+            {
+                m_tileKeyToIndexMap[MakeTileKey(tileX, tileY)] = m_tileList.size();
+                m_tileList.push_back(Tile());
+            }
+            FindTile(tileX, tileY);
+            return m_tileList[m_lastTileIndex];
+        }
+    };
+
     Board m_board;
     BigInt m_boardMinX = MAX_BIG_INT;
     BigInt m_boardMaxX = MIN_BIG_INT;
     BigInt m_boardMinY = MAX_BIG_INT;
     BigInt m_boardMaxY = MIN_BIG_INT;
 
+    struct Pos
+    {
+        BigInt x = 0;
+        BigInt y = 0;
+    };
+
+    // cells the last grain fell through, starting at the source.  Only the cell a grain comes to rest in changes the
+    // board, so the next grain retraces this same path up to the cell just above it, and can simply start there.
+    std::vector<Pos> m_fallPath;
+
     void RunOnData(const char* filename, bool verbose)
     {
         printf("For file '%s'...\n", filename);
@@ -62,9 +184,17 @@ private:
         // part two
 
         m_board = pristineBoard;
+        m_fallPath.clear();
 
         BuildFloor(verbose);
 
+        const BigInt numSandSettledByRows = CountSandSettledWithFloorByRows();
+        printf("Num grains of sand settled with a floor, counted row by row = %lld\n\n", numSandSettledByRows);
+
+        Board stripBoard = m_board;
+        const BigInt numSandSettledInStrips = SettleSandWithFloorInStrips(stripBoard, 4);
+        printf("Num grains of sand settled with a floor, in parallel strips = %lld\n\n", numSandSettledInStrips);
+
         numSandSettled = 0;
         fellToMaxY = false;
         cloggedSource = false;
@@ -80,6 +210,10 @@ private:
         }
 
         printf("Num grains of sand settled with a floor = %lld\n\n", numSandSettled);
+        assert(numSandSettled == numSandSettledByRows);
+        assert(numSandSettled == numSandSettledInStrips);
+        if (verbose)
+            CheckSandMatches(stripBoard);
 
         PrintBoard();
         printf("\n");
@@ -90,10 +224,9 @@ private:
 
     void InitBoardFromLines(const StringList& lines, bool verbose)
     {
-        m_board.clear();
-        m_board.resize(MAX_GRID_SIZE);
-        for (std::string& row: m_board)
-            row.resize(MAX_GRID_SIZE, '.');
+        m_board = Board();
+
+        m_fallPath.clear();
 
         SetBoardChar(SAND_SOURCE_X, SAND_SOURCE_Y, '+');
 
@@ -103,14 +236,14 @@ private:
 
             BigInt x = 0;
             BigInt y = 0;
-            ParseNextBigInt(st, x);
-            ParseNextBigInt(st, y);
+            ParseNextBigInt(st, x, true /*checkForNegation*/);
+            ParseNextBigInt(st, y, true /*checkForNegation*/);
 
             SetBoardChar(x, y, '#');
 
             BigInt destX = 0;
             BigInt destY = 0;
-            while (ParseNextBigInt(st, destX) && ParseNextBigInt(st, destY))
+            while (ParseNextBigInt(st, destX, true /*checkForNegation*/) && ParseNextBigInt(st, destY, true /*checkForNegation*/))
             {
                 BigInt stepX = 0;
                 if (destX > x)
@@ -143,17 +276,187 @@ private:
     {
         ++m_boardMaxY;
         const BigInt floorY = m_boardMaxY;
-        for (BigInt x = 0; x < (BigInt)m_board[0].length(); ++x)
-            m_board[floorY][x] = '#';   // fill the floor but don't let it alter the mins + maxes anymore
+        m_board.SetFloorY(floorY);   // the floor doesn't alter the mins + maxes anymore
 
         if (verbose)
             PrintBoard();
     }
 
+    // With a floor, every cell the sand can reach from the source (stepping down, down-left or down-right, without
+    // passing through rock) ends up filled, so the settled grains can be counted row by row without simulating any.
+    // Each row is a bitset spread one cell each way from the row above, minus that row's rock.
+    BigInt CountSandSettledWithFloorByRows() const
+    {
+        const BigInt floorY = m_boardMaxY;
+        // the widest the sand can ever spread is at the floor; line the bitset up with whole tiles there, so each word
+        // of a row is exactly one tile's row of rock bits
+        const BigInt minTileX = Board::ToTileCoord(SAND_SOURCE_X - floorY);
+        const BigInt minX = minTileX * Board::TILE_SIZE;
+        const BigInt numWords = Board::ToTileCoord(SAND_SOURCE_X + floorY) - minTileX + 1;
+
+        BitWordList reachRow(numWords, 0);
+        BitWordList nextRow(numWords, 0);
+        BitWordList rockRow(numWords, 0);
+
+        const BigInt sourceBit = SAND_SOURCE_X - minX;
+        reachRow[sourceBit / 64] = 1ULL << (sourceBit % 64);
+        BigInt numSettled = 1;
+
+        for (BigInt y = SAND_SOURCE_Y + 1; y < floorY; ++y)
+        {
+            for (BigInt w = 0; w < numWords; ++w)
+                rockRow[w] = m_board.GetRockRowBits(minTileX + w, y);
+
+            bool anyReached = false;
+            for (BigInt w = 0; w < numWords; ++w)
+            {
+                const BigUInt lowerWord = (w > 0) ? reachRow[w - 1] : 0;
+                const BigUInt upperWord = (w + 1 < numWords) ? reachRow[w + 1] : 0;
+                const BigUInt spread = reachRow[w] | (reachRow[w] << 1) | (lowerWord >> 63) | (reachRow[w] >> 1) | (upperWord << 63);
+                nextRow[w] = spread & ~rockRow[w];
+
+                numSettled += CountBits(nextRow[w]);
+                anyReached = anyReached || (nextRow[w] != 0);
+            }
+
+            reachRow.swap(nextRow);
+            if (!anyReached)
+                break;
+        }
+
+        return numSettled;
+    }
+
+    // Settles the same sand as CountSandSettledWithFloorByRows into the given board, with the columns split into
+    // vertical strips worked on in parallel.  Sand spreads at most one column per row, so a strip padded with one
+    // word of halo columns on each side can run a whole band of TILE_SIZE rows on its own before its edges go stale.
+    // After each band, the strips' interiors are merged back in strip order, which keeps the result deterministic.
+    BigInt SettleSandWithFloorInStrips(Board& board, BigInt numStrips) const
+    {
+        static const BigInt HALO_WORDS = 1;
+        static const BigInt BAND_HEIGHT = HALO_WORDS * Board::TILE_SIZE;
+
+        const BigInt floorY = m_boardMaxY;
+        const BigInt minTileX = Board::ToTileCoord(SAND_SOURCE_X - floorY);
+        const BigInt minX = minTileX * Board::TILE_SIZE;
+        const BigInt numWords = Board::ToTileCoord(SAND_SOURCE_X + floorY) - minTileX + 1;
+        const BigInt stripWords = (numWords + numStrips - 1) / numStrips;
+        const BigInt localWords = stripWords + 2 * HALO_WORDS;
+
+        BitWordList reachRow(numWords, 0);
+        const BigInt sourceBit = SAND_SOURCE_X - minX;
+        reachRow[sourceBit / 64] = 1ULL << (sourceBit % 64);
+        board.SetCell(SAND_SOURCE_X, SAND_SOURCE_Y, Board::SAND);
+        BigInt numSettled = 1;
+
+        // per strip, the interior words of every row in the band
+        std::vector<BitWordList> stripBandList(numStrips);
+        BigIntList stripNumSettledList(numStrips);
+
+        for (BigInt bandStartY = SAND_SOURCE_Y + 1; bandStartY < floorY; bandStartY += BAND_HEIGHT)
+        {
+            const BigInt bandHeight = std::min(BAND_HEIGHT, floorY - bandStartY);
+
+            ParallelFor(
+                numStrips,
+                [&](BigInt stripIndex)
+                {
+                    const BigInt firstWord = stripIndex * stripWords - HALO_WORDS;
+
+                    BitWordList localReach(localWords, 0);
+                    BitWordList localNext(localWords, 0);
+                    for (BigInt w = 0; w < localWords; ++w)
+                    {
+                        if ((firstWord + w >= 0) && (firstWord + w < numWords))
+                            localReach[w] = reachRow[firstWord + w];
+                    }
+
+                    BitWordList& band = stripBandList[stripIndex];
+                    band.assign(bandHeight * stripWords, 0);
+                    BigInt stripNumSettled = 0;
+
+                    for (BigInt row = 0; row < bandHeight; ++row)
+                    {
+                        for (BigInt w = 0; w < localWords; ++w)
+                        {
+                            const BigUInt lowerWord = (w > 0) ? localReach[w - 1] : 0;
+                            const BigUInt upperWord = (w + 1 < localWords) ? localReach[w + 1] : 0;
+                            const BigUInt spread
+                                = localReach[w] | (localReach[w] << 1) | (lowerWord >> 63) | (localReach[w] >> 1) | (upperWord << 63);
+                            const BigUInt rockBits = ((firstWord + w >= 0) && (firstWord + w < numWords))
+                                ? board.GetRockRowBits(minTileX + firstWord + w, bandStartY + row)
+                                : 0;
+                            localNext[w] = spread & ~rockBits;
+                        }
+                        localReach.swap(localNext);
+
+                        for (BigInt w = 0; w < stripWords; ++w)
+                        {
+                            const BigUInt bits = localReach[HALO_WORDS + w];
+                            band[row * stripWords + w] = bits;
+                            stripNumSettled += CountBits(bits);
+                        }
+                    }
+
+                    stripNumSettledList[stripIndex] = stripNumSettled;
+                });
+
+            // merge the strips back into the board and the shared reachable row
+            for (BigInt stripIndex = 0; stripIndex < numStrips; ++stripIndex)
+            {
+                const BitWordList& band = stripBandList[stripIndex];
+                for (BigInt w = 0; w < stripWords; ++w)
+                {
+                    const BigInt word = stripIndex * stripWords + w;
+                    if (word >= numWords)
+                        break;
+
+                    for (BigInt row = 0; row < bandHeight; ++row)
+                    {
+                        const BigUInt bits = band[row * stripWords + w];
+                        if (bits != 0)
+                            board.AddRowBits(minTileX + word, bandStartY + row, Board::SAND, bits);
+                    }
+                    reachRow[word] = band[(bandHeight - 1) * stripWords + w];
+                }
+                numSettled += stripNumSettledList[stripIndex];
+            }
+        }
+
+        return numSettled;
+    }
+
+    void CheckSandMatches(const Board& otherBoard) const
+    {
+        BigInt numMismatches = 0;
+        for (BigInt y = m_boardMinY; y <= m_boardMaxY; ++y)
+        {
+            for (BigInt x = m_boardMinX; x <= m_boardMaxX; ++x)
+            {
+                if (m_board.HasCell(x, y, Board::SAND) != otherBoard.HasCell(x, y, Board::SAND))
+                    ++numMismatches;
+            }
+        }
+
+        if (numMismatches == 0)
+            printf("Sand settled in parallel strips matches the grain by grain board\n\n");
+        else
+            printf("Sand settled in parallel strips DOESN'T match the grain by grain board at %lld locations!\n\n", numMismatches);
+    }
+
     void DropOneSand(bool& fellToMaxY, bool& cloggedSource, bool drawPath, bool verbose)
     {
-        BigInt x = SAND_SOURCE_X;
-        BigInt y = SAND_SOURCE_Y;
+        if (m_fallPath.empty())
+            m_fallPath.push_back({ SAND_SOURCE_X, SAND_SOURCE_Y });
+
+        if (drawPath)
+        {
+            for (BigInt i = 1; i < (BigInt)m_fallPath.size(); ++i)
+                SetBoardChar(m_fallPath[i].x, m_fallPath[i].y, '~');
+        }
+
+        BigInt x = m_fallPath.back().x;
+        BigInt y = m_fallPath.back().y;
 
         fellToMaxY = false;
         for (;;)
@@ -167,12 +470,22 @@ private:
                     TryMoveSandOneStep(x, y, +1, +1, drawPath, didMove, fellToMaxY);
             }
 
+            if (didMove)
+                m_fallPath.push_back({ x, y });
+
             if (!didMove || fellToMaxY)
                 break;
         }
 
         if (!fellToMaxY)
+        {
             SetBoardChar(x, y, 'o');
+            m_fallPath.pop_back();   // the resting cell is blocked now, so the next grain starts just above it
+        }
+        else
+        {
+            m_fallPath.clear();   // grains falling into the abyss don't settle, so there is nothing to resume from
+        }
 
         if ((x == SAND_SOURCE_X) && (y == SAND_SOURCE_Y))
             cloggedSource = true;
@@ -189,7 +502,7 @@ private:
         const BigInt newX = x + stepX;
         const BigInt newY = y + stepY;
 
-        if (m_board[newY][newX] != '.')
+        if (m_board.IsBlocked(newX, newY))
             return;
 
         x += stepX;
@@ -205,7 +518,20 @@ private:
 
     void SetBoardChar(BigInt x, BigInt y, char ch)
     {
-        m_board[y][x] = ch;
+        switch (ch)
+        {
+            case '#':
+                m_board.SetCell(x, y, Board::ROCK);
+                break;
+            case 'o':
+                m_board.SetCell(x, y, Board::SAND);
+                break;
+            case '~':
+                m_board.SetCell(x, y, Board::PATH);
+                break;
+            default:
+                break;   // the source is drawn at print time
+        }
         AbsorbMinMaxPos(x, y);
     }
 
@@ -229,6 +555,19 @@ private:
         ++m_boardMaxY;
     }
 
+    char GetBoardChar(BigInt x, BigInt y) const
+    {
+        if (m_board.HasCell(x, y, Board::ROCK))
+            return '#';
+        if (m_board.HasCell(x, y, Board::SAND))
+            return 'o';
+        if (m_board.HasCell(x, y, Board::PATH))
+            return '~';
+        if ((x == SAND_SOURCE_X) && (y == SAND_SOURCE_Y))
+            return '+';
+        return '.';
+    }
+
     void PrintBoard()
     {
         printf("Board:\n");
@@ -236,7 +575,7 @@ private:
         {
             printf("  ");
             for (BigInt x = m_boardMinX; x <= m_boardMaxX; ++x)
-                printf("%c", (int)m_board[y][x]);
+                printf("%c", (int)GetBoardChar(x, y));
             printf("\n");
         }
         printf("\n\n");
@@ -15,7 +15,7 @@ public:
     }
 
 private:
-    typedef std::deque<char> Stack;
+    typedef std::vector<char> Stack;   // bottom crate first, so a move of N crates is one contiguous block at the end
     typedef std::vector<Stack> StackList;
 
     void RunOnData(const char* filename, bool verbose)
@@ -47,7 +47,7 @@ private:
                     if (stackIndex >= (BigInt)stackList.size())
                         stackList.resize(stackIndex + 1);
 
-                    stackList[stackIndex].push_front(line[charIndex + 1]);
+                    stackList[stackIndex].push_back(line[charIndex + 1]);
                 }
 
                 charIndex += 4;
@@ -56,6 +56,10 @@ private:
         }
         printf("Found stack numbers line:  %s\n", lines[lineIndex].c_str());
 
+        // the drawing is read top down, so flip each stack to have its bottom crate first
+        for (Stack& stack: stackList)
+            std::reverse(stack.begin(), stack.end());
+
         ++lineIndex;   // skip past stack numbers line
         ++lineIndex;   // skip blank line
 
@@ -69,7 +73,6 @@ private:
         StackList partTwoStackList = stackList;
 
         StringList tokens;
-        Stack reversedMoveStack;
         for (; lineIndex < (BigInt)lines.size(); ++lineIndex)
         {
             Tokenize(lines[lineIndex], tokens, ' ');
@@ -81,49 +84,24 @@ private:
             if (verbose)
                 printf("Moving %lld items from stack index %lld to %lld:\n  ", numToMove, fromStackIndex, toStackIndex);
 
-            // part one
-
-            for (BigInt i = 0; i < numToMove; ++i)
-            {
-                const char item = stackList[fromStackIndex].back();
-
-                if (verbose)
-                    printf("%c ", (int)item);
-
-                stackList[fromStackIndex].pop_back();
-                stackList[toStackIndex].push_back(item);
-            }
-            if (verbose)
-                printf("\n");
+            // part one: the crane lifts one crate at a time, so the block lands reversed.  Copy it across in bulk,
+            // reading the source block backwards
 
+            MoveCrates(stackList[fromStackIndex], stackList[toStackIndex], numToMove, true);
             if (verbose)
+            {
+                PrintMovedCrates(stackList[toStackIndex], numToMove);
                 PrintStacks(stackList);
+            }
 
-            // part two
+            // part two: the whole block moves at once and keeps its order
 
+            MoveCrates(partTwoStackList[fromStackIndex], partTwoStackList[toStackIndex], numToMove, false);
             if (verbose)
-                printf("\n  ");
-
-            reversedMoveStack.clear();
-            for (BigInt i = 0; i < numToMove; ++i)
             {
-                const char item = partTwoStackList[fromStackIndex].back();
-                partTwoStackList[fromStackIndex].pop_back();
-                reversedMoveStack.push_front(item);
-            }
-
-            while (!reversedMoveStack.empty())
-            {
-                const char item = reversedMoveStack.front();
-
-                if (verbose)
-                    printf("%c ", (int)item);
-
-                partTwoStackList[toStackIndex].push_back(item);
-                reversedMoveStack.pop_front();
+                printf("\n  ");
+                PrintMovedCrates(partTwoStackList[toStackIndex], numToMove);
             }
-            if (verbose)
-                printf("\n");
 
             if (verbose)
                 PrintStacks(partTwoStackList);
@@ -154,6 +132,29 @@ private:
         printf("\n\n");
     }
 
+    // moves the top numToMove crates as one block, either keeping their order or reversing it
+    static void MoveCrates(Stack& fromStack, Stack& toStack, BigInt numToMove, bool reverseOrder)
+    {
+        assert(numToMove <= (BigInt)fromStack.size());
+        if (&fromStack == &toStack)
+            return;   // either way the crates end up back where they started
+
+        const BigInt blockStart = (BigInt)fromStack.size() - numToMove;
+        if (reverseOrder)
+            toStack.insert(toStack.end(), fromStack.rbegin(), fromStack.rbegin() + numToMove);
+        else
+            toStack.insert(toStack.end(), fromStack.begin() + blockStart, fromStack.end());
+        fromStack.resize(blockStart);
+    }
+
+    // prints the crates just moved onto the stack, in the order they were set down
+    static void PrintMovedCrates(const Stack& toStack, BigInt numMoved)
+    {
+        for (BigInt i = (BigInt)toStack.size() - numMoved; i < (BigInt)toStack.size(); ++i)
+            printf("%c ", (int)toStack[i]);
+        printf("\n");
+    }
+
     void PrintStacks(const StackList& stackList)
     {
         printf("Stacks:\n");
@@ -14,156 +14,290 @@ public:
         RunOnData("Day7Input.txt", false);
     }
 
+    // The directory tree lives in flat arenas addressed by uint32_t indices: directories and files each in one vector,
+    // linked to their siblings by index, with every name interned once into a shared pool.  Looking up a child by
+    // (parent, name) goes through a hash table, so parsing a log costs no per-entry allocations beyond arena growth.
     class FileSystem
     {
     public:
-        FileSystem() : rootDir("/") { workingPath.push(&rootDir); }
+        FileSystem()
+        {
+            AddDir(HashIndexTable::NO_INDEX, InternName("/", 1));
+            workingPath.push_back((uint32_t)ROOT_DIR);
+        }
 
-        void ChangeDir(const std::string& dir)
+        void ChangeDir(const char* name, BigInt nameLength)
         {
-            if (dir[0] == '/')
+            if (name[0] == '/')
             {
-                while (workingPath.top()->name != "/")
-                    workingPath.pop();
+                workingPath.resize(1);
             }
-            else if (dir == "..")
+            else if ((nameLength == 2) && (name[0] == '.') && (name[1] == '.'))
             {
-                workingPath.pop();
+                workingPath.pop_back();
             }
             else
             {
-                Directory& newDir = workingPath.top()->dirs[dir];
-                if (newDir.name.empty())
-                    newDir.name = dir;
-                workingPath.push(&newDir);
+                workingPath.push_back(FindOrAddDir(workingPath.back(), InternName(name, nameLength)));
             }
         }
 
         void AddDirContent(const std::string& line)
         {
-            StringList tokens;
-            Tokenize(line, tokens, ' ');
-            if (tokens[0] == "dir")
+            if (line.compare(0, 4, "dir ") == 0)
             {
-                Directory& newDir = workingPath.top()->dirs[tokens[1]];
-                if (newDir.name.empty())
-                    newDir.name = tokens[1];
+                FindOrAddDir(workingPath.back(), InternName(line.c_str() + 4, (BigInt)line.length() - 4));
             }
             else
             {
-                workingPath.top()->files[tokens[1]] = atoll(tokens[0].c_str());
+                char* nameStart = nullptr;
+                const BigInt size = strtoll(line.c_str(), &nameStart, 10);
+                ++nameStart;   // skip the space
+                const BigInt nameLength = (BigInt)line.length() - (nameStart - line.c_str());
+                SetFile(InternName(nameStart, nameLength), size);
             }
         }
 
         void PrintTree()
         {
-            std::string indent;
             printf("Tree:\n\n/:\n");
-            PrintDir(indent, rootDir);
+
+            // depth first with an explicit stack, pushing subdirectories in reverse so they come off in name order
+            std::vector<std::pair<uint32_t, BigInt>> dirStack;
+            dirStack.push_back(std::make_pair((uint32_t)ROOT_DIR, (BigInt)0));
+            std::vector<uint32_t> dirFiles;
+            std::vector<uint32_t> subDirs;
+            while (!dirStack.empty())
+            {
+                const uint32_t dirIndex = dirStack.back().first;
+                const BigInt depth = dirStack.back().second;
+                dirStack.pop_back();
+
+                if (dirIndex != ROOT_DIR)
+                    printf("%*sdir '%s'\n", (int)(depth * 2), "", GetName(dirs[dirIndex].nameId));
+
+                GetSortedFiles(dirIndex, dirFiles);
+                for (uint32_t fileIndex: dirFiles)
+                {
+                    printf("%*sfile '%s', %lld\n", (int)((depth + 1) * 2), "", GetName(files[fileIndex].nameId), files[fileIndex].size);
+                }
+
+                GetSortedSubDirs(dirIndex, subDirs);
+                for (auto it = subDirs.rbegin(); it != subDirs.rend(); ++it)
+                    dirStack.push_back(std::make_pair(*it, depth + 1));
+            }
         }
 
-        void CalcTotalSizeDirsAtSizeLimit(BigInt sizeLimit, BigInt& totalSize, BigInt& totalAtSizeLimit, bool verbose)
+        BigInt GetTotalSize() const { return dirSizes[ROOT_DIR]; }
+
+        BigInt CalcTotalSizeDirsAtSizeLimit(BigInt sizeLimit, bool verbose) const
         {
-            totalSize = 0;
-            totalAtSizeLimit = 0;
-            CalcTotalSizeDirsAtSizeLimit(rootDir, sizeLimit, totalSize, totalAtSizeLimit, verbose);
+            BigInt totalAtSizeLimit = 0;
+            for (BigInt dirIndex = 0; dirIndex < (BigInt)dirSizes.size(); ++dirIndex)
+            {
+                const BigInt totalSize = dirSizes[dirIndex];
+                if (verbose)
+                    printf("dir %s has total of %lld\n", GetName(dirs[dirIndex].nameId), totalSize);
+                if (totalSize <= sizeLimit)
+                {
+                    totalAtSizeLimit += totalSize;
+                    if (verbose)
+                        printf("  is <= %lld, so it adds to running total at size limit\n", sizeLimit);
+                }
+            }
+            return totalAtSizeLimit;
         }
 
-        BigInt CalcSizeOfSmallestDirToFreeUpSpace(BigInt spaceToFreeUp, bool verbose)
+        BigInt CalcSizeOfSmallestDirToFreeUpSpace(BigInt spaceToFreeUp, bool verbose) const
         {
             BigInt smallestDirSize = -1;
-            BigInt totalSize = 0;
-            CalcSizeOfSmallestDirToFreeUpSpace(rootDir, spaceToFreeUp, smallestDirSize, totalSize, verbose);
+            for (BigInt dirIndex = 0; dirIndex < (BigInt)dirSizes.size(); ++dirIndex)
+            {
+                const BigInt totalSize = dirSizes[dirIndex];
+                if (verbose)
+                    printf("dir %s has total of %lld\n", GetName(dirs[dirIndex].nameId), totalSize);
+                if ((totalSize >= spaceToFreeUp) && ((smallestDirSize < 0) || (totalSize < smallestDirSize)))
+                {
+                    if (verbose)
+                        printf("  is >= %lld and < %lld, so it becomes our new selected size\n", spaceToFreeUp, smallestDirSize);
+                    smallestDirSize = totalSize;
+                }
+            }
             return smallestDirSize;
         }
 
+        // the sizes of the numDirs largest directories, largest first
+        void GetLargestDirSizes(BigInt numDirs, std::vector<BigInt>& sizes)
+        {
+            UpdateSortedDirSizes();
+            sizes.assign(sortedDirSizes.rbegin(), sortedDirSizes.rbegin() + std::min(numDirs, (BigInt)sortedDirSizes.size()));
+        }
+
+        BigInt CountDirsInSizeRange(BigInt minSize, BigInt maxSize)
+        {
+            UpdateSortedDirSizes();
+            auto begin = std::lower_bound(sortedDirSizes.begin(), sortedDirSizes.end(), minSize);
+            auto end = std::upper_bound(begin, sortedDirSizes.end(), maxSize);
+            return (BigInt)(end - begin);
+        }
+
     private:
+        static const uint32_t ROOT_DIR = 0;
+
         struct Directory
         {
-            Directory() = default;
-            Directory(const char* n) : name(n) {}
+            uint32_t nameId;
+            uint32_t parentIndex;
+            uint32_t firstDirIndex;    // subdirectories, linked through nextDirIndex
+            uint32_t nextDirIndex;
+            uint32_t firstFileIndex;   // files, linked through nextFileIndex
+        };
 
-            std::string name;
-            std::map<std::string, BigInt> files;
-            std::map<std::string, Directory> dirs;
+        struct File
+        {
+            uint32_t nameId;
+            uint32_t nextFileIndex;
+            BigInt size;
         };
 
-        Directory rootDir;
-        std::stack<Directory*> workingPath;
+        std::vector<Directory> dirs;
+        std::vector<File> files;
+        std::vector<uint32_t> workingPath;
+        std::vector<BigInt> dirSizes;          // total size of each dir, by dir index, kept current as files are added
+        std::vector<BigInt> sortedDirSizes;    // rebuilt on demand for the order queries
+        bool sortedDirSizesValid = false;
 
-        void PrintDir(std::string& indent, const Directory& dir)
+        std::vector<char> namePool;            // every distinct name once, each null terminated
+        std::vector<uint32_t> nameOffsets;     // name id -> offset of the name in namePool
+        HashIndexTable nameTable;              // name hash -> name id
+        HashIndexTable dirTable;               // (parent dir, name id) -> dir index
+        HashIndexTable fileTable;              // (parent dir, name id) -> file index
+
+        const char* GetName(uint32_t nameId) const { return &namePool[nameOffsets[nameId]]; }
+
+        static BigUInt HashName(const char* name, BigInt nameLength)
         {
-            indent.push_back(' ');
-            indent.push_back(' ');
+            BigUInt hash = 0xCBF29CE484222325ULL;
+            for (BigInt i = 0; i < nameLength; ++i)
+                hash = (hash ^ (uint8_t)name[i]) * 0x100000001B3ULL;
+            return hash;
+        }
+
+        static BigUInt MakeChildKey(uint32_t parentIndex, uint32_t nameId) { return ((BigUInt)parentIndex << 32) | nameId; }
 
-            for (const auto& fileNode: dir.files)
+        uint32_t InternName(const char* name, BigInt nameLength)
+        {
+            const BigUInt hash = HashName(name, nameLength);
+            uint32_t nameId = nameTable.Find(
+                hash,
+                [&](uint32_t candidateId)
+                {
+                    const char* candidate = GetName(candidateId);
+                    return (strncmp(candidate, name, nameLength) == 0) && (candidate[nameLength] == '\0');
+                });
+
+            if (nameId == HashIndexTable::NO_INDEX)
             {
-                printf("%sfile '%s', %lld\n", indent.c_str(), fileNode.first.c_str(), fileNode.second);
+                nameId = (uint32_t)nameOffsets.size();
+                nameOffsets.push_back((uint32_t)namePool.size());
+                namePool.insert(namePool.end(), name, name + nameLength);
+                namePool.push_back('\0');
+                nameTable.Insert(hash, nameId);
             }
+            return nameId;
+        }
 
-            for (const auto& dirNode: dir.dirs)
+        uint32_t AddDir(uint32_t parentIndex, uint32_t nameId)
+        {
+            const uint32_t dirIndex = (uint32_t)dirs.size();
+
+            Directory dir;
+            dir.nameId = nameId;
+            dir.parentIndex = parentIndex;
+            dir.firstDirIndex = HashIndexTable::NO_INDEX;
+            dir.nextDirIndex = HashIndexTable::NO_INDEX;
+            dir.firstFileIndex = HashIndexTable::NO_INDEX;
+            if (parentIndex != HashIndexTable::NO_INDEX)
             {
-                printf("%sdir '%s'\n", indent.c_str(), dirNode.first.c_str());
-
-                PrintDir(indent, dirNode.second);
+                dir.nextDirIndex = dirs[parentIndex].firstDirIndex;
+                dirs[parentIndex].firstDirIndex = dirIndex;
+                dirTable.Insert(MakeChildKey(parentIndex, nameId), dirIndex);
             }
+            dirs.push_back(dir);
+            dirSizes.push_back(0);
+            sortedDirSizesValid = false;
+            return dirIndex;
+        }
 
-            indent.pop_back();
-            indent.pop_back();
+        uint32_t FindOrAddDir(uint32_t parentIndex, uint32_t nameId)
+        {
+            const uint32_t dirIndex = dirTable.Find(MakeChildKey(parentIndex, nameId));
+            if (dirIndex != HashIndexTable::NO_INDEX)
+                return dirIndex;
+            return AddDir(parentIndex, nameId);
         }
 
-        void CalcTotalSizeDirsAtSizeLimit(const Directory& dir, BigInt sizeLimit, BigInt& totalSize, BigInt& totalAtSizeLimit, bool verbose)
+        // adds or resizes a file in the working directory, passing the change in size up through every directory on
+        // the working path so all their totals stay current
+        void SetFile(uint32_t nameId, BigInt size)
         {
-            totalSize = 0;
+            const uint32_t dirIndex = workingPath.back();
+            const BigUInt key = MakeChildKey(dirIndex, nameId);
+            BigInt sizeChange = size;
 
-            for (const auto& fileNode: dir.files)
+            const uint32_t fileIndex = fileTable.Find(key);
+            if (fileIndex != HashIndexTable::NO_INDEX)
             {
-                totalSize += fileNode.second;
+                sizeChange = size - files[fileIndex].size;
+                files[fileIndex].size = size;
             }
-
-            for (const auto& dirNode: dir.dirs)
+            else
             {
-                BigInt subDirTotal = 0;
-                CalcTotalSizeDirsAtSizeLimit(dirNode.second, sizeLimit, subDirTotal, totalAtSizeLimit, verbose);
-                totalSize += subDirTotal;
+                File file;
+                file.nameId = nameId;
+                file.nextFileIndex = dirs[dirIndex].firstFileIndex;
+                file.size = size;
+                dirs[dirIndex].firstFileIndex = (uint32_t)files.size();
+                fileTable.Insert(key, (uint32_t)files.size());
+                files.push_back(file);
             }
 
-            if (verbose)
-                printf("dir %s has total of %lld\n", dir.name.c_str(), totalSize);
-            if (totalSize <= sizeLimit)
-            {
-                totalAtSizeLimit += totalSize;
-                if (verbose)
-                    printf("  is <= %lld, so it adds to running total at size limit\n", sizeLimit);
-            }
+            for (uint32_t pathDirIndex: workingPath)
+                dirSizes[pathDirIndex] += sizeChange;
+            sortedDirSizesValid = false;
         }
 
-        void CalcSizeOfSmallestDirToFreeUpSpace(
-            const Directory& dir, BigInt spaceToFreeUp, BigInt& smallestDirSize, BigInt& totalSize, bool verbose)
+        void UpdateSortedDirSizes()
         {
-            totalSize = 0;
+            if (sortedDirSizesValid)
+                return;
 
-            for (const auto& fileNode: dir.files)
-            {
-                totalSize += fileNode.second;
-            }
+            sortedDirSizes = dirSizes;
+            std::sort(sortedDirSizes.begin(), sortedDirSizes.end());
+            sortedDirSizesValid = true;
+        }
 
-            for (const auto& dirNode: dir.dirs)
-            {
-                BigInt subDirTotal = 0;
-                CalcSizeOfSmallestDirToFreeUpSpace(
-                    dirNode.second, spaceToFreeUp, smallestDirSize, subDirTotal, verbose);
-                totalSize += subDirTotal;
-            }
+        // children come out of the sibling links newest first; gather them in name order instead
+        void GetSortedSubDirs(uint32_t dirIndex, std::vector<uint32_t>& subDirs) const
+        {
+            subDirs.clear();
+            for (uint32_t subDirIndex = dirs[dirIndex].firstDirIndex; subDirIndex != HashIndexTable::NO_INDEX; subDirIndex = dirs[subDirIndex].nextDirIndex)
+                subDirs.push_back(subDirIndex);
+            std::sort(
+                subDirs.begin(),
+                subDirs.end(),
+                [&](uint32_t lhs, uint32_t rhs) { return strcmp(GetName(dirs[lhs].nameId), GetName(dirs[rhs].nameId)) < 0; });
+        }
 
-            if (verbose)
-                printf("dir %s has total of %lld\n", dir.name.c_str(), totalSize);
-            if ((totalSize >= spaceToFreeUp) && ((smallestDirSize < 0) || (totalSize < smallestDirSize)))
-            {
-                if (verbose)
-                    printf("  is >= %lld and < %lld, so it becomes our new selected size\n", spaceToFreeUp, smallestDirSize);
-                smallestDirSize = totalSize;
-            }
+        void GetSortedFiles(uint32_t dirIndex, std::vector<uint32_t>& dirFiles) const
+        {
+            dirFiles.clear();
+            for (uint32_t fileIndex = dirs[dirIndex].firstFileIndex; fileIndex != HashIndexTable::NO_INDEX; fileIndex = files[fileIndex].nextFileIndex)
+                dirFiles.push_back(fileIndex);
+            std::sort(
+                dirFiles.begin(),
+                dirFiles.end(),
+                [&](uint32_t lhs, uint32_t rhs) { return strcmp(GetName(files[lhs].nameId), GetName(files[rhs].nameId)) < 0; });
         }
     };
 
@@ -186,28 +320,25 @@ public:
             {
                 fs.AddDirContent(line);
             }
-            else
+            else if (line.compare(0, 5, "$ cd ") == 0)
             {
-                StringList tokens;
-                Tokenize(line, tokens, ' ');
+                fs.ChangeDir(line.c_str() + 5, (BigInt)line.length() - 5);
 
-                if (tokens[1] == "cd")
-                {
-                    fs.ChangeDir(tokens[2]);
-                }
-                else if (tokens[1] == "ls")
-                {
-                    inLS = true;
-                }
+                // directory totals are kept current while parsing, so the answers are available at any point in the log
+                if (verbose)
+                    printf("At '%s': total size so far = %lld, total at size limit so far = %lld\n", line.c_str(), fs.GetTotalSize(), fs.CalcTotalSizeDirsAtSizeLimit(100000, false));
+            }
+            else if (line.compare(0, 4, "$ ls") == 0)
+            {
+                inLS = true;
             }
         }
 
         if (verbose)
             fs.PrintTree();
 
-        BigInt totalSize = 0;
-        BigInt totalAtSizeLimit = 0;
-        fs.CalcTotalSizeDirsAtSizeLimit(100000, totalSize, totalAtSizeLimit, verbose);
+        const BigInt totalSize = fs.GetTotalSize();
+        const BigInt totalAtSizeLimit = fs.CalcTotalSizeDirsAtSizeLimit(100000, verbose);
         printf("Total at size limit = %lld\n\n", totalAtSizeLimit);
 
         const BigInt totalCapacity = 70000000LL;
@@ -228,6 +359,14 @@ public:
         printf(
             "Found smallest directory to delete in order to free up the required space.  Dir size = %lld\n",
             smallestDirSizeToFreeUp);
+
+        std::vector<BigInt> largestDirSizes;
+        fs.GetLargestDirSizes(3, largestDirSizes);
+        printf("Largest directory sizes:");
+        for (BigInt dirSize: largestDirSizes)
+            printf(" %lld", dirSize);
+        printf("\n");
+        printf("Num dirs of size %lld to %lld = %lld\n\n", spaceToFreeUp, totalSize, fs.CountDirsInSizeRange(spaceToFreeUp, totalSize));
     }
 };
 
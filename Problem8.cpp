@@ -12,118 +12,336 @@ public:
     {
         RunOnData("Day8Example.txt", true);
         RunOnData("Day8Input.txt", false);
+
+        RunOnDataParallel("Day8Example.txt");
+        RunOnDataParallel("Day8Input.txt");
+
+        RunOnDataRunningMax("Day8Example.txt");
+        RunOnDataRunningMax("Day8Input.txt");
     }
 
 private:
-    enum Direction
+    typedef std::vector<uint8_t> HeightList;
+    typedef std::vector<uint32_t> ViewDistList;
+
+    static const uint32_t HEIGHT_BITS = 4;
+    static const uint32_t HEIGHT_MASK = (1 << HEIGHT_BITS) - 1;
+
+    // Tree heights stored row by row in one flat array, a byte per tree
+    class Forest
     {
-        WEST,
-        NORTH,
-        EAST,
-        SOUTH,
+    public:
+        void Load(const StringList& lines)
+        {
+            m_sizeX = lines.empty() ? 0 : (BigInt)lines[0].length();
+            m_sizeY = 0;
+            m_heightList.clear();
+            m_heightList.reserve(m_sizeX * (BigInt)lines.size());
+            for (const std::string& line: lines)
+            {
+                if ((BigInt)line.length() < m_sizeX)
+                    continue;
+
+                for (BigInt x = 0; x < m_sizeX; ++x)
+                    m_heightList.push_back((uint8_t)(line[x] - '0'));
+                ++m_sizeY;
+            }
+        }
+
+        BigInt GetSizeX() const { return m_sizeX; }
+        BigInt GetSizeY() const { return m_sizeY; }
+        const uint8_t* GetHeights() const { return m_heightList.data(); }
+
+    private:
+        BigInt m_sizeX = 0;
+        BigInt m_sizeY = 0;
+        HeightList m_heightList;
     };
 
-    typedef std::vector<bool> TreeVisGridRow;
-    typedef std::vector<TreeVisGridRow> TreeVisGrid;
+    // Sweeps one line of trees (a row or a column, picked out by its stride) in both directions with a monotonic stack.
+    // Walking forwards, the stack holds the trees not yet hidden behind a later tree at least as tall, so once the
+    // shorter ones are popped the top of the stack is the tree that blocks the view.  A tree is visible from that end
+    // if nothing is left on the stack.  Each tree is pushed and popped at most once per direction.
+    //
+    // Fills in whether each tree is visible from either end of the line, and the product of its two viewing distances.
+    // Stack entries carry the tree's height in their low bits next to its index, so popping never has to go back out
+    // to the (possibly strided) height array.
+    static void SweepLine(
+        const uint8_t* heights,
+        BigInt stride,
+        BigInt count,
+        uint8_t* lineVisible,
+        uint32_t* lineViewDistProduct,
+        std::vector<uint32_t>& stack)
+    {
+        stack.clear();
+        for (BigInt i = 0; i < count; ++i)
+        {
+            const uint8_t height = heights[i * stride];
+            while (!stack.empty() && ((uint8_t)(stack.back() & HEIGHT_MASK) < height))
+                stack.pop_back();
 
-    typedef std::vector<BigInt> TreeScoreGridRow;
-    typedef std::vector<TreeScoreGridRow> TreeScoreGrid;
+            lineVisible[i] = stack.empty() ? 1 : 0;
+            lineViewDistProduct[i] = (uint32_t)(stack.empty() ? i : (i - (stack.back() >> HEIGHT_BITS)));
+            stack.push_back(((uint32_t)i << HEIGHT_BITS) | height);
+        }
 
-    void RunOnData(const char* filename, bool verbose)
+        stack.clear();
+        for (BigInt i = count - 1; i >= 0; --i)
+        {
+            const uint8_t height = heights[i * stride];
+            while (!stack.empty() && ((uint8_t)(stack.back() & HEIGHT_MASK) < height))
+                stack.pop_back();
+
+            lineVisible[i] |= stack.empty() ? 1 : 0;
+            lineViewDistProduct[i] *= (uint32_t)(stack.empty() ? (count - 1 - i) : ((stack.back() >> HEIGHT_BITS) - i));
+            stack.push_back(((uint32_t)i << HEIGHT_BITS) | height);
+        }
+    }
+
+    // Same sweeps as RunOnData, spread over threads.  Rows are swept in independent bands, then columns are handled in
+    // strips of STRIP_WIDTH: each strip's heights are gathered into a column-major tile so its column sweeps read
+    // contiguous memory, and the tile's results are folded against the row results a cache-friendly row at a time.
+    // Each strip leaves its own partial totals, which are then combined in strip order, so the answer doesn't depend
+    // on how the threads were scheduled.
+    static void SweepInParallel(const Forest& forest, BigInt& totalNumVisibleTrees, BigInt& largestTreeScore)
     {
-        printf("For file '%s'...\n", filename);
+        static const BigInt ROW_BAND_HEIGHT = 64;
+        static const BigInt STRIP_WIDTH = 64;
 
-        StringList lines;
-        ReadFileLines(filename, lines);
+        const BigInt gridSizeX = forest.GetSizeX();
+        const BigInt gridSizeY = forest.GetSizeY();
+        const uint8_t* heights = forest.GetHeights();
 
-        const BigInt gridSizeX = (BigInt)lines[0].length();
-        const BigInt gridSizeY = (BigInt)lines.size();
+        HeightList treeVisList(gridSizeX * gridSizeY, 0);
+        ViewDistList rowViewDistList(gridSizeX * gridSizeY, 0);
 
-        // initialize tree vis and score grids
+        const BigInt numRowBands = (gridSizeY + ROW_BAND_HEIGHT - 1) / ROW_BAND_HEIGHT;
+        ParallelFor(
+            numRowBands,
+            [&](BigInt bandIndex)
+            {
+                std::vector<uint32_t> stack;
+                const BigInt endY = std::min(gridSizeY, (bandIndex + 1) * ROW_BAND_HEIGHT);
+                for (BigInt treeY = bandIndex * ROW_BAND_HEIGHT; treeY < endY; ++treeY)
+                {
+                    const BigInt rowStart = treeY * gridSizeX;
+                    SweepLine(&heights[rowStart], 1, gridSizeX, &treeVisList[rowStart], &rowViewDistList[rowStart], stack);
+                }
+            });
+
+        const BigInt numStrips = (gridSizeX + STRIP_WIDTH - 1) / STRIP_WIDTH;
+        std::vector<BigInt> stripNumVisibleList(numStrips, 0);
+        std::vector<BigInt> stripLargestScoreList(numStrips, 0);
+        ParallelFor(
+            numStrips,
+            [&](BigInt stripIndex)
+            {
+                const BigInt startX = stripIndex * STRIP_WIDTH;
+                const BigInt stripWidth = std::min((BigInt)STRIP_WIDTH, gridSizeX - startX);
 
-        TreeVisGrid treeVisGrid;
-        treeVisGrid.resize(gridSizeY);
-        for (TreeVisGridRow& row: treeVisGrid)
+                HeightList tileHeightList(stripWidth * gridSizeY);
+                for (BigInt treeY = 0; treeY < gridSizeY; ++treeY)
+                {
+                    const uint8_t* rowHeights = &heights[treeY * gridSizeX + startX];
+                    for (BigInt column = 0; column < stripWidth; ++column)
+                        tileHeightList[column * gridSizeY + treeY] = rowHeights[column];
+                }
+
+                HeightList tileVisList(stripWidth * gridSizeY);
+                ViewDistList tileViewDistList(stripWidth * gridSizeY);
+                std::vector<uint32_t> stack;
+                for (BigInt column = 0; column < stripWidth; ++column)
+                {
+                    const BigInt columnStart = column * gridSizeY;
+                    SweepLine(
+                        &tileHeightList[columnStart],
+                        1,
+                        gridSizeY,
+                        &tileVisList[columnStart],
+                        &tileViewDistList[columnStart],
+                        stack);
+                }
+
+                BigInt numVisible = 0;
+                BigInt largestScore = 0;
+                for (BigInt treeY = 0; treeY < gridSizeY; ++treeY)
+                {
+                    const BigInt rowStart = treeY * gridSizeX + startX;
+                    for (BigInt column = 0; column < stripWidth; ++column)
+                    {
+                        const BigInt tileIndex = column * gridSizeY + treeY;
+                        numVisible += treeVisList[rowStart + column] | tileVisList[tileIndex];
+
+                        const BigInt treeScore = (BigInt)rowViewDistList[rowStart + column] * (BigInt)tileViewDistList[tileIndex];
+                        largestScore = std::max(largestScore, treeScore);
+                    }
+                }
+
+                stripNumVisibleList[stripIndex] = numVisible;
+                stripLargestScoreList[stripIndex] = largestScore;
+            });
+
+        totalNumVisibleTrees = 0;
+        largestTreeScore = 0;
+        for (BigInt stripIndex = 0; stripIndex < numStrips; ++stripIndex)
         {
-            row.resize(gridSizeX, false);
+            totalNumVisibleTrees += stripNumVisibleList[stripIndex];
+            largestTreeScore = std::max(largestTreeScore, stripLargestScoreList[stripIndex]);
         }
+    }
 
-        TreeScoreGrid treeScoreGrid;
-        treeScoreGrid.resize(gridSizeY);
-        for (TreeScoreGridRow& row: treeScoreGrid)
+    // Visibility from one side only needs a running max of the heights seen so far, so many lines can be handled side
+    // by side.  Heights are offset by one so an empty running max of 0 lets the edge trees through.  The loop has no
+    // branches or cross-element dependencies, so the compiler turns it into byte-wise vector max and compare.
+    static void UpdateRunningMax(const uint8_t* heights, uint8_t* runningMax, uint8_t* visible, BigInt count)
+    {
+        for (BigInt i = 0; i < count; ++i)
         {
-            row.resize(gridSizeX, 0);
+            const uint8_t height = (uint8_t)(heights[i] + 1);
+            visible[i] |= (uint8_t)(height > runningMax[i]);
+            runningMax[i] = std::max(runningMax[i], height);
         }
+    }
 
-        // recurse through trees, tracing visibility and taking advantage of previous visibility calculations where possible to shortcut checks
+    static void OrVisibleIntoBits(const uint8_t* visible, BigInt count, BigUInt* bitWords)
+    {
+        for (BigInt i = 0; i < count; ++i)
+            bitWords[i >> 6] |= (BigUInt)visible[i] << (i & 63);
+    }
 
-        BigInt totalNumVisibleTrees = 0;
-        BigInt largestTreeScore = 0;
+    // Part one alone, by running maxes.  North and south walk down and up the rows with a running max per column.  West
+    // and east take TILE_ROWS rows at a time, transposed so the same kernel walks along them with a running max per row.
+    // Visibility is collected as a bitmap per row and counted by popcount.
+    static BigInt CountVisibleTreesByRunningMax(const Forest& forest)
+    {
+        static const BigInt TILE_ROWS = 64;
+
+        const BigInt gridSizeX = forest.GetSizeX();
+        const BigInt gridSizeY = forest.GetSizeY();
+        const uint8_t* heights = forest.GetHeights();
 
+        const BigInt numRowWords = (gridSizeX + 63) / 64;
+        BitWordList visibleBits(numRowWords * gridSizeY, 0);
+
+        HeightList runningMaxList(gridSizeX);
+        HeightList visibleList(gridSizeX);
+
+        std::fill(runningMaxList.begin(), runningMaxList.end(), (uint8_t)0);
         for (BigInt treeY = 0; treeY < gridSizeY; ++treeY)
         {
+            std::fill(visibleList.begin(), visibleList.end(), (uint8_t)0);
+            UpdateRunningMax(&heights[treeY * gridSizeX], runningMaxList.data(), visibleList.data(), gridSizeX);
+            OrVisibleIntoBits(visibleList.data(), gridSizeX, &visibleBits[treeY * numRowWords]);
+        }
+
+        std::fill(runningMaxList.begin(), runningMaxList.end(), (uint8_t)0);
+        for (BigInt treeY = gridSizeY - 1; treeY >= 0; --treeY)
+        {
+            std::fill(visibleList.begin(), visibleList.end(), (uint8_t)0);
+            UpdateRunningMax(&heights[treeY * gridSizeX], runningMaxList.data(), visibleList.data(), gridSizeX);
+            OrVisibleIntoBits(visibleList.data(), gridSizeX, &visibleBits[treeY * numRowWords]);
+        }
+
+        HeightList tileHeightList(gridSizeX * TILE_ROWS);
+        HeightList tileVisibleList(gridSizeX * TILE_ROWS);
+        HeightList tileRunningMaxList(TILE_ROWS);
+        for (BigInt startY = 0; startY < gridSizeY; startY += TILE_ROWS)
+        {
+            const BigInt tileRows = std::min((BigInt)TILE_ROWS, gridSizeY - startY);
+
+            for (BigInt row = 0; row < tileRows; ++row)
+            {
+                const uint8_t* rowHeights = &heights[(startY + row) * gridSizeX];
+                for (BigInt treeX = 0; treeX < gridSizeX; ++treeX)
+                    tileHeightList[treeX * tileRows + row] = rowHeights[treeX];
+            }
+            std::fill(tileVisibleList.begin(), tileVisibleList.end(), (uint8_t)0);
+
+            std::fill(tileRunningMaxList.begin(), tileRunningMaxList.end(), (uint8_t)0);
             for (BigInt treeX = 0; treeX < gridSizeX; ++treeX)
             {
-                if (verbose)
-                    printf("Looking at tree <%lld,%lld>\n", treeX, treeY);
+                const BigInt tileIndex = treeX * tileRows;
+                UpdateRunningMax(&tileHeightList[tileIndex], tileRunningMaxList.data(), &tileVisibleList[tileIndex], tileRows);
+            }
 
-                const char sourceHeight = lines[treeY][treeX];
+            std::fill(tileRunningMaxList.begin(), tileRunningMaxList.end(), (uint8_t)0);
+            for (BigInt treeX = gridSizeX - 1; treeX >= 0; --treeX)
+            {
+                const BigInt tileIndex = treeX * tileRows;
+                UpdateRunningMax(&tileHeightList[tileIndex], tileRunningMaxList.data(), &tileVisibleList[tileIndex], tileRows);
+            }
 
-                bool isVisible = false;
-                BigInt treeScore = 1;
-                BigInt treeScoreDir = 0;
+            for (BigInt row = 0; row < tileRows; ++row)
+            {
+                for (BigInt treeX = 0; treeX < gridSizeX; ++treeX)
+                    visibleList[treeX] = tileVisibleList[treeX * tileRows + row];
+                OrVisibleIntoBits(visibleList.data(), gridSizeX, &visibleBits[(startY + row) * numRowWords]);
+            }
+        }
 
-                isVisible |= TraceFromTree(gridSizeX, gridSizeY, lines, treeX, treeY, WEST, sourceHeight, treeScoreDir, verbose);
-                treeScore *= treeScoreDir;
-                treeScoreDir = 0;
-                if (verbose)
-                    printf("  Score in WEST direction = %lld\n", treeScoreDir);
+        BigInt numVisibleTrees = 0;
+        for (BigUInt bitWord: visibleBits)
+            numVisibleTrees += CountBits(bitWord);
+        return numVisibleTrees;
+    }
 
-                isVisible |= TraceFromTree(gridSizeX, gridSizeY, lines, treeX, treeY, NORTH, sourceHeight, treeScoreDir, verbose);
-                treeScore *= treeScoreDir;
-                treeScoreDir = 0;
-                if (verbose)
-                    printf("  Score in NORTH direction = %lld\n", treeScoreDir);
+    void RunOnData(const char* filename, bool verbose)
+    {
+        printf("For file '%s'...\n", filename);
 
-                isVisible |= TraceFromTree(gridSizeX, gridSizeY, lines, treeX, treeY, EAST, sourceHeight, treeScoreDir, verbose);
-                treeScore *= treeScoreDir;
-                treeScoreDir = 0;
-                if (verbose)
-                    printf("  Score in EAST direction = %lld\n", treeScoreDir);
+        StringList lines;
+        ReadFileLines(filename, lines);
 
-                isVisible |= TraceFromTree(gridSizeX, gridSizeY, lines, treeX, treeY, SOUTH, sourceHeight, treeScoreDir, verbose);
-                treeScore *= treeScoreDir;
-                treeScoreDir = 0;
-                if (verbose)
-                    printf("  Score in SOUTH direction = %lld\n", treeScoreDir);
+        Forest forest;
+        forest.Load(lines);
 
-                if (isVisible)
-                {
-                    ++totalNumVisibleTrees;
-                    treeVisGrid[treeY][treeX] = true;
+        const BigInt gridSizeX = forest.GetSizeX();
+        const BigInt gridSizeY = forest.GetSizeY();
+        const uint8_t* heights = forest.GetHeights();
 
-                    if (verbose)
-                        printf("  Tree is VISIBLE.  total num visible = %lld\n", totalNumVisibleTrees);
-                }
-                else
-                {
-                    if (verbose)
-                        printf("  Tree is NOT visible.  total num visible = %lld\n", totalNumVisibleTrees);
-                }
+        // sweep every row, keeping the west/east visibility and view distance product for each tree
 
-                if (verbose)
-                    printf("  Tree score = %lld\n", treeScore);
+        HeightList treeVisList(gridSizeX * gridSizeY, 0);
+        ViewDistList rowViewDistList(gridSizeX * gridSizeY, 0);
+        std::vector<uint32_t> stack;
 
-                treeScoreGrid[treeY][treeX] = treeScore;
-                if (treeScore > largestTreeScore)
-                {
-                    largestTreeScore = treeScore;
-                    if (verbose)
-                        printf("  This is the largest tree score so far!\n");
-                }
+        for (BigInt treeY = 0; treeY < gridSizeY; ++treeY)
+        {
+            const BigInt rowStart = treeY * gridSizeX;
+            SweepLine(&heights[rowStart], 1, gridSizeX, &treeVisList[rowStart], &rowViewDistList[rowStart], stack);
+        }
+
+        // then sweep every column, folding its north/south results straight into the totals
+
+        BigInt totalNumVisibleTrees = 0;
+        BigInt largestTreeScore = 0;
+
+        std::vector<BigInt> treeScoreList;
+        if (verbose)
+            treeScoreList.resize(gridSizeX * gridSizeY, 0);
+
+        HeightList columnVisList(gridSizeY, 0);
+        ViewDistList columnViewDistList(gridSizeY, 0);
+        for (BigInt treeX = 0; treeX < gridSizeX; ++treeX)
+        {
+            SweepLine(&heights[treeX], gridSizeX, gridSizeY, columnVisList.data(), columnViewDistList.data(), stack);
+
+            for (BigInt treeY = 0; treeY < gridSizeY; ++treeY)
+            {
+                const BigInt treeIndex = treeY * gridSizeX + treeX;
+
+                treeVisList[treeIndex] |= columnVisList[treeY];
+                totalNumVisibleTrees += treeVisList[treeIndex];
+
+                const BigInt treeScore = (BigInt)rowViewDistList[treeIndex] * (BigInt)columnViewDistList[treeY];
+                largestTreeScore = std::max(largestTreeScore, treeScore);
+                if (verbose)
+                    treeScoreList[treeIndex] = treeScore;
             }
         }
 
+
         printf("Total number of visible trees = %lld\n", totalNumVisibleTrees);
         printf("Largest tree score = %lld\n\n", largestTreeScore);
 
@@ -135,7 +353,7 @@ private:
                 printf("  ");
                 for (BigInt treeX = 0; treeX < gridSizeX; ++treeX)
                 {
-                    printf("%c", treeVisGrid[treeY][treeX] ? (int)'1' : (int)'0');
+                    printf("%c", treeVisList[treeY * gridSizeX + treeX] ? (int)'1' : (int)'0');
                 }
                 printf("\n");
             }
@@ -147,7 +365,7 @@ private:
                 printf("  ");
                 for (BigInt treeX = 0; treeX < gridSizeX; ++treeX)
                 {
-                    printf("%lld ", treeScoreGrid[treeY][treeX]);
+                    printf("%lld ", treeScoreList[treeY * gridSizeX + treeX]);
                 }
                 printf("\n");
             }
@@ -155,65 +373,36 @@ private:
         }
     }
 
-    bool TraceFromTree(
-        BigInt gridSizeX,
-        BigInt gridSizeY,
-        const StringList& lines,
-        BigInt currX,
-        BigInt currY,
-        Direction stepDir,
-        char sourceHeight,
-        BigInt& treeScore,
-        bool verbose)
+    void RunOnDataParallel(const char* filename)
     {
-        static const BigInt s_stepXList[] = { -1, 0, +1, 0 };
-        static const BigInt s_stepYList[] = { 0, -1, 0, +1 };
+        printf("For file '%s', sweeping in parallel...\n", filename);
 
-        const BigInt stepX = s_stepXList[stepDir];
-        const BigInt stepY = s_stepYList[stepDir];
+        StringList lines;
+        ReadFileLines(filename, lines);
 
-        currX += stepX;
-        currY += stepY;
+        Forest forest;
+        forest.Load(lines);
 
-        if (verbose)
-            printf("  stepping in direction <%lld,%lld> to cell <%lld,%lld>\n", stepX, stepY, currX, currY);
+        BigInt totalNumVisibleTrees = 0;
+        BigInt largestTreeScore = 0;
+        SweepInParallel(forest, totalNumVisibleTrees, largestTreeScore);
 
-        bool steppedCellIsVisible = false;
-        BigInt steppedCellScore = 0;
+        printf("Total number of visible trees = %lld\n", totalNumVisibleTrees);
+        printf("Largest tree score = %lld\n\n", largestTreeScore);
+    }
 
-        if ((currX < 0) || (currX >= gridSizeX))
-        {
-            steppedCellIsVisible = true;
-            if (verbose)
-                printf("  reached edge via X = %lld, so visibility is TRUE!\n", currX);
-        }
-        else if ((currY < 0) || (currY >= gridSizeY))
-        {
-            steppedCellIsVisible = true;
-            if (verbose)
-                printf("  reached edge via Y = %lld, so visibility is TRUE!\n", currY);
-        }
-        else if (lines[currY][currX] >= sourceHeight)
-        {
-            steppedCellScore = 1;
-            if (verbose)
-                printf(
-                    "  reached a tree which has height %c >= source height %c, so visibility is FALSE!\n",
-                    (int)lines[currY][currX],
-                    (int)sourceHeight);
-        }
-        else
-        {
-            steppedCellIsVisible =
-                TraceFromTree(gridSizeX, gridSizeY, lines, currX, currY, stepDir, sourceHeight, steppedCellScore, verbose);
-            
-            // don't forget to include this tree
-            ++steppedCellScore;
-        }
+    // part one only
+    void RunOnDataRunningMax(const char* filename)
+    {
+        printf("For file '%s', by running max...\n", filename);
+
+        StringList lines;
+        ReadFileLines(filename, lines);
 
-        treeScore += steppedCellScore;
+        Forest forest;
+        forest.Load(lines);
 
-        return steppedCellIsVisible;
+        printf("Total number of visible trees = %lld\n\n", CountVisibleTreesByRunningMax(forest));
     }
 };
 
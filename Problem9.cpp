@@ -17,6 +17,9 @@ public:
 
         RunOnData("Day9Input.txt", 2, false);
         RunOnData("Day9Input.txt", 10, false);
+        RunOnData("Day9Input.txt", 256, false);
+
+        RunAllRopeLengths("Day9Input.txt", 10);
     }
 
 private:
@@ -25,8 +28,8 @@ private:
     public:
         Rope(BigInt numKnots, BigInt startX, BigInt startY)
         {
-            m_xList.resize(numKnots, startX);
-            m_yList.resize(numKnots, startY);
+            m_xList.resize(numKnots, (int32_t)startX);
+            m_yList.resize(numKnots, (int32_t)startY);
         }
 
         BigInt GetNumKnots() const { return (BigInt)m_xList.size(); }
@@ -39,13 +42,34 @@ private:
 
         void StepHead(BigInt stepX, BigInt stepY)
         {
-            m_xList[0] += stepX;
-            m_yList[0] += stepY;
+            m_xList[0] += (int32_t)stepX;
+            m_yList[0] += (int32_t)stepY;
 
             for (BigInt knotIndex = 1; knotIndex < (BigInt)m_xList.size(); ++knotIndex)
                 StepKnot(knotIndex);
         }
 
+        // whether every knot sits exactly one step behind the one before it, along the given step.  Once that's true,
+        // every further step of the head just moves each knot by that same step.
+        bool IsTrailingStraight(BigInt stepX, BigInt stepY) const
+        {
+            for (BigInt knotIndex = 1; knotIndex < (BigInt)m_xList.size(); ++knotIndex)
+            {
+                if ((m_xList[knotIndex] != m_xList[knotIndex - 1] - stepX) || (m_yList[knotIndex] != m_yList[knotIndex - 1] - stepY))
+                    return false;
+            }
+            return true;
+        }
+
+        void MoveAllKnots(BigInt moveX, BigInt moveY)
+        {
+            for (BigInt knotIndex = 0; knotIndex < (BigInt)m_xList.size(); ++knotIndex)
+            {
+                m_xList[knotIndex] += (int32_t)moveX;
+                m_yList[knotIndex] += (int32_t)moveY;
+            }
+        }
+
         bool GetCharForLocation(BigInt x, BigInt y, char& ch) const
         {
             for (BigInt knotIndex = 0; knotIndex < (BigInt)m_xList.size(); ++knotIndex)
@@ -57,7 +81,7 @@ private:
                     else if (knotIndex == ((BigInt)m_xList.size() - 1))
                         ch = 'T';
                     else
-                        ch = (char)('0' + knotIndex);
+                        ch = (knotIndex < 10) ? (char)('0' + knotIndex) : '#';
                     return true;
                 }
             }
@@ -66,60 +90,61 @@ private:
         }
 
     private:
+        // branchless follow: the knot moves by sign(diff) on each axis, but only when the Chebyshev distance to the knot
+        // ahead is over 1.  Each knot depends on the one ahead's new position, so the chain stays sequential, but with
+        // no data-dependent branches it runs at a steady rate however the rope is bent.
         void StepKnot(BigInt knotIndex)
         {
-            const BigInt diffX = m_xList[knotIndex - 1] - m_xList[knotIndex];
-            const BigInt diffY = m_yList[knotIndex - 1] - m_yList[knotIndex];
-            if (diffX < -1)
-            {
-                --m_xList[knotIndex];
-                if (diffY < 0)
-                    --m_yList[knotIndex];
-                else if (diffY > 0)
-                    ++m_yList[knotIndex];
-            }
-            else if (diffX > +1)
-            {
-                ++m_xList[knotIndex];
-                if (diffY < 0)
-                    --m_yList[knotIndex];
-                else if (diffY > 0)
-                    ++m_yList[knotIndex];
-            }
-            else if (diffY < -1)
-            {
-                --m_yList[knotIndex];
-                if (diffX < 0)
-                    --m_xList[knotIndex];
-                else if (diffX > 0)
-                    ++m_xList[knotIndex];
-            }
-            else if (diffY > +1)
-            {
-                ++m_yList[knotIndex];
-                if (diffX < 0)
-                    --m_xList[knotIndex];
-                else if (diffX > 0)
-                    ++m_xList[knotIndex];
-            }
+            const int32_t diffX = m_xList[knotIndex - 1] - m_xList[knotIndex];
+            const int32_t diffY = m_yList[knotIndex - 1] - m_yList[knotIndex];
+            const int32_t absX = (diffX ^ (diffX >> 31)) - (diffX >> 31);
+            const int32_t absY = (diffY ^ (diffY >> 31)) - (diffY >> 31);
+            const int32_t moveMask = -(int32_t)((absX > 1) | (absY > 1));
+            m_xList[knotIndex] += ((diffX > 0) - (diffX < 0)) & moveMask;
+            m_yList[knotIndex] += ((diffY > 0) - (diffY < 0)) & moveMask;
         }
 
-        std::vector<BigInt> m_xList;
-        std::vector<BigInt> m_yList;
+        std::vector<int32_t> m_xList;
+        std::vector<int32_t> m_yList;
     };
 
-    class Board
+    // Hash set of (x,y) positions packed into 64-bit keys, so visited locations can be tracked over any area while only
+    // costing memory for the locations actually visited
+    class PositionSet
     {
     public:
-        Board()
+        BigInt GetSize() const { return m_table.GetSize(); }
+
+        bool Contains(BigInt x, BigInt y) const { return m_table.Find(PackKey(x, y)) != HashIndexTable::NO_INDEX; }
+
+        // returns whether the position is new to the set
+        bool Insert(BigInt x, BigInt y)
         {
-            m_currBoard.resize(MAX_SIZE);
-            for (std::vector<bool>& row: m_currBoard)
-                row.resize(MAX_SIZE, false);
+            const BigUInt key = PackKey(x, y);
+            if (m_table.Find(key) != HashIndexTable::NO_INDEX)
+                return false;
+
+            m_table.Insert(key, (uint32_t)m_table.GetSize());
+            return true;
+        }
+
+    private:
+        HashIndexTable m_table;
+
+        static BigUInt PackKey(BigInt x, BigInt y)
+        {
+            assert((x >= INT32_MIN) && (x <= INT32_MAX) && (y >= INT32_MIN) && (y <= INT32_MAX));
+            return ((BigUInt)(x - INT32_MIN) << 32) | (BigUInt)(y - INT32_MIN);
         }
+    };
 
+    class Board
+    {
+    public:
         void GetStartPos(BigInt& x, BigInt& y) const { x = y = START_POS; }
 
+        BigInt GetNumVisited() const { return m_visitedSet.GetSize(); }
+
         bool MarkVisited(const Rope& rope)
         {
             BigInt knotIndex = 0;
@@ -134,10 +159,22 @@ private:
 
             rope.GetKnotPos(knotIndex, x, y);
             UpdateMinMax(x, y);
-            const bool prevVisited = m_currBoard[y][x];
-            m_currBoard[y][x] = true;
+            return !m_visitedSet.Insert(x, y);
+        }
 
-            return prevVisited;
+        // marks the straight run of locations the tail just passed through, ending at its current location
+        void MarkVisitedRun(const Rope& rope, BigInt stepX, BigInt stepY, BigInt numSteps)
+        {
+            BigInt x = 0;
+            BigInt y = 0;
+            for (BigInt knotIndex = 0; knotIndex < rope.GetNumKnots(); ++knotIndex)
+            {
+                rope.GetKnotPos(knotIndex, x, y);
+                UpdateMinMax(x, y);
+            }
+
+            for (BigInt i = 0; i < numSteps; ++i)
+                m_visitedSet.Insert(x - i * stepX, y - i * stepY);
         }
 
         void Print(const Rope& rope)
@@ -151,7 +188,7 @@ private:
                     char ch;
                     if (rope.GetCharForLocation(x, y, ch))
                         printf("%c", (int)ch);
-                    else if (m_currBoard[y][x])
+                    else if (m_visitedSet.Contains(x, y))
                         printf("#");
                     else
                         printf(".");
@@ -175,9 +212,8 @@ private:
                 m_maxVisitedY = y + 1;
         }
 
-        static const BigInt MAX_SIZE = 2048;
-        static const BigInt START_POS = MAX_SIZE / 2;
-        std::vector<std::vector<bool>> m_currBoard;
+        static const BigInt START_POS = 0;
+        PositionSet m_visitedSet;
 
         BigInt m_minVisitedX = START_POS;
         BigInt m_maxVisitedX = START_POS;
@@ -185,48 +221,88 @@ private:
         BigInt m_maxVisitedY = START_POS;
     };
 
-    void RunOnData(const char* filename, BigInt numKnots, bool verbose)
+    struct Move
     {
-        printf("For file '%s', with rope with %lld knots...\n", filename, numKnots);
+        char dir;
+        int8_t stepX;
+        int8_t stepY;
+        uint32_t numSteps;
+    };
+    typedef std::vector<Move> MoveList;
 
+    // reads the whole move script once into a compact list, so it can be replayed against any number of ropes
+    static void ParseMoves(const char* filename, MoveList& moves)
+    {
         StringList lines;
         ReadFileLines(filename, lines);
 
+        moves.clear();
+        moves.reserve(lines.size());
+        for (const std::string& line: lines)
+        {
+            if (line.size() < 3)
+                continue;
+
+            BigInt stepX = 0;
+            BigInt stepY = 0;
+            GetDirStep(line[0], stepX, stepY);
+
+            Move move;
+            move.dir = line[0];
+            move.stepX = (int8_t)stepX;
+            move.stepY = (int8_t)stepY;
+            move.numSteps = (uint32_t)atoll(line.c_str() + 2);
+            moves.push_back(move);
+        }
+    }
+
+    void RunOnData(const char* filename, BigInt numKnots, bool verbose)
+    {
+        printf("For file '%s', with rope with %lld knots...\n", filename, numKnots);
+
+        MoveList moves;
+        ParseMoves(filename, moves);
+
         BigInt startX = 0;
         BigInt startY = 0;
         Board board;
         board.GetStartPos(startX, startY);
-        BigInt numVisitedLocations = 1;
 
         Rope rope(numKnots, startX, startY);
         board.MarkVisited(rope);
 
-        for (const std::string& line: lines)
+        for (const Move& move: moves)
         {
-            StringList tokens;
-            Tokenize(line, tokens, ' ');
-
-            BigInt stepX = 0;
-            BigInt stepY = 0;
-            GetDirStep(tokens[0][0], stepX, stepY);
-
-            const BigInt numSteps = atoll(tokens[1].c_str());
+            const BigInt stepX = move.stepX;
+            const BigInt stepY = move.stepY;
+            const BigInt numSteps = move.numSteps;
 
             if (verbose)
-                printf("Stepping '%c' (%lld,%lld) x %lld\n", (int)tokens[0][0], stepX, stepY, numSteps);
+                printf("Stepping '%c' (%lld,%lld) x %lld\n", (int)move.dir, stepX, stepY, numSteps);
 
             for (BigInt i = 0; i < numSteps; ++i)
             {
-                rope.StepHead(stepX, stepY);
-
-                const bool wasPreviouslyVisited = board.MarkVisited(rope);
-                if (!wasPreviouslyVisited)
+                if (rope.IsTrailingStraight(stepX, stepY))
                 {
-                    ++numVisitedLocations;
+                    // the rest of the move is the whole rope sliding along in a line
+                    const BigInt numRunSteps = numSteps - i;
+                    rope.MoveAllKnots(stepX * numRunSteps, stepY * numRunSteps);
+                    board.MarkVisitedRun(rope, stepX, stepY, numRunSteps);
+
                     if (verbose)
-                        printf("  Tail visiting new location\n");
+                    {
+                        printf("  Rope slides straight for the last %lld steps\n\n", numRunSteps);
+                        board.Print(rope);
+                    }
+                    break;
                 }
 
+                rope.StepHead(stepX, stepY);
+
+                const bool wasPreviouslyVisited = board.MarkVisited(rope);
+                if (!wasPreviouslyVisited && verbose)
+                    printf("  Tail visiting new location\n");
+
                 if (verbose)
                 {
                     printf("\n");
@@ -235,7 +311,58 @@ private:
             }
         }
 
-        printf("Num visited locations = %lld\n\n", numVisitedLocations);
+        printf("Num visited locations = %lld\n\n", board.GetNumVisited());
+    }
+
+    // simulates only the longest rope, tracking the locations visited by every knot.  Knot k of a long rope moves
+    // exactly as the tail of a (k+1)-knot rope would, so one pass answers every rope length from 2 up to maxNumKnots.
+    void RunAllRopeLengths(const char* filename, BigInt maxNumKnots)
+    {
+        printf("For file '%s', with every rope length up to %lld knots...\n", filename, maxNumKnots);
+
+        MoveList moves;
+        ParseMoves(filename, moves);
+
+        Rope rope(maxNumKnots, 0, 0);
+        std::vector<PositionSet> visitedSetList(maxNumKnots);
+        for (PositionSet& visitedSet: visitedSetList)
+            visitedSet.Insert(0, 0);
+
+        BigInt x = 0;
+        BigInt y = 0;
+        for (const Move& move: moves)
+        {
+            const BigInt stepX = move.stepX;
+            const BigInt stepY = move.stepY;
+            const BigInt numSteps = move.numSteps;
+            for (BigInt i = 0; i < numSteps; ++i)
+            {
+                if (rope.IsTrailingStraight(stepX, stepY))
+                {
+                    // every knot slides along its own straight run for the rest of the move
+                    const BigInt numRunSteps = numSteps - i;
+                    rope.MoveAllKnots(stepX * numRunSteps, stepY * numRunSteps);
+                    for (BigInt knotIndex = 1; knotIndex < maxNumKnots; ++knotIndex)
+                    {
+                        rope.GetKnotPos(knotIndex, x, y);
+                        for (BigInt runIndex = 0; runIndex < numRunSteps; ++runIndex)
+                            visitedSetList[knotIndex].Insert(x - runIndex * stepX, y - runIndex * stepY);
+                    }
+                    break;
+                }
+
+                rope.StepHead(stepX, stepY);
+                for (BigInt knotIndex = 1; knotIndex < maxNumKnots; ++knotIndex)
+                {
+                    rope.GetKnotPos(knotIndex, x, y);
+                    visitedSetList[knotIndex].Insert(x, y);
+                }
+            }
+        }
+
+        for (BigInt numKnots = 2; numKnots <= maxNumKnots; ++numKnots)
+            printf("  Rope with %lld knots: num visited locations = %lld\n", numKnots, visitedSetList[numKnots - 1].GetSize());
+        printf("\n");
     }
 
     static void GetDirStep(char dir, BigInt& stepX, BigInt& stepY)